@@ -0,0 +1,204 @@
+/*
+  base64.c - base64 and base64url encoder
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include "base64.h"
+
+/**
+ * @file
+ * The vector encoders follow W. Mula and D. Lemire, "Faster Base64 Encoding
+ * and Decoding Using AVX2 Instructions" (2018): a byte shuffle puts the 3
+ * input bytes of each output quadruple into one 32-bit lane, two 16-bit
+ * multiplies move the four 6-bit fields into separate bytes, and a 16-entry
+ * pshufb table adds the offset that maps each range of indices to its ASCII
+ * range.
+ */
+
+static const char alphabet[2][65] = {
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/",
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789-_"
+};
+
+unsigned long long base64_length(unsigned long long len, int flags)
+{
+	if(flags & base64_nopad)
+		return len / 3 * 4 + (len % 3 ? len % 3 + 1 : 0);
+	return (len + 2) / 3 * 4;
+}
+
+/* Encode whole 3-byte groups; returns the number of input bytes consumed. */
+static unsigned int encode_scalar(
+		const unsigned char *in,
+		unsigned int len,
+		char *out,
+		const char *cvt)
+{
+	unsigned int i, v;
+
+	/*
+	 * SECURITY NOTE: 3 bytes of input at a time pass through a register
+	 * or the stack.
+	 */
+	for(i = 0; i + 3 <= len; i += 3) {
+		v = in[i] << 16 | in[i+1] << 8 | in[i+2];
+		*out++ = cvt[v >> 18];
+		*out++ = cvt[(v >> 12) & 0x3f];
+		*out++ = cvt[(v >> 6) & 0x3f];
+		*out++ = cvt[v & 0x3f];
+	}
+	return i;
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define	HAVE_SIMD_BASE64
+
+#include <immintrin.h>
+
+/* Offsets for '+' and '/' (or '-' and '_') in the translation table. */
+#define	OFFSET_62(url)	((url) ? '-' - 62 : '+' - 62)
+#define	OFFSET_63(url)	((url) ? '_' - 63 : '/' - 63)
+
+__attribute__((target("ssse3")))
+static __m128i reshuffle_128(__m128i in)
+{
+	__m128i t0, t1, t2, t3;
+
+	in = _mm_shuffle_epi8(in, _mm_set_epi8(
+			10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+	t0 = _mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00));
+	t1 = _mm_mulhi_epu16(t0, _mm_set1_epi32(0x04000040));
+	t2 = _mm_and_si128(in, _mm_set1_epi32(0x003f03f0));
+	t3 = _mm_mullo_epi16(t2, _mm_set1_epi32(0x01000010));
+	return _mm_or_si128(t1, t3);
+}
+
+__attribute__((target("ssse3")))
+static __m128i translate_128(__m128i idx, __m128i lut)
+{
+	__m128i r;
+
+	/* 52..63 -> 1..12, 26..51 -> 0, 0..25 -> 13 */
+	r = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+	r = _mm_or_si128(r, _mm_and_si128(
+			_mm_cmpgt_epi8(_mm_set1_epi8(26), idx), _mm_set1_epi8(13)));
+	return _mm_add_epi8(idx, _mm_shuffle_epi8(lut, r));
+}
+
+/* Consumes 12 bytes per step but loads 16, so it stops 4 bytes early. */
+__attribute__((target("ssse3")))
+static unsigned int encode_ssse3(
+		const unsigned char *in,
+		unsigned int len,
+		char *out,
+		int url)
+{
+	__m128i lut = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, OFFSET_62(url), OFFSET_63(url), 'A', 0, 0);
+	unsigned int i;
+
+	for(i = 0; i + 16 <= len; i += 12, out += 16)
+		_mm_storeu_si128((__m128i*)out, translate_128(reshuffle_128(
+				_mm_loadu_si128((const __m128i*)(in + i))), lut));
+	return i;
+}
+
+__attribute__((target("avx2")))
+static unsigned int encode_avx2(
+		const unsigned char *in,
+		unsigned int len,
+		char *out,
+		int url)
+{
+	__m256i lut = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, OFFSET_62(url), OFFSET_63(url), 'A', 0, 0,
+			'a' - 26, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, OFFSET_62(url), OFFSET_63(url), 'A', 0, 0);
+	__m256i v, t0, t1, t2, t3, r;
+	unsigned int i;
+
+	/* each 128-bit lane takes 12 of the 24 bytes, as in encode_ssse3 */
+	for(i = 0; i + 28 <= len; i += 24, out += 32) {
+		v = _mm256_inserti128_si256(_mm256_castsi128_si256(
+				_mm_loadu_si128((const __m128i*)(in + i))),
+				_mm_loadu_si128((const __m128i*)(in + i + 12)), 1);
+		v = _mm256_shuffle_epi8(v, _mm256_set_epi8(
+				10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1,
+				10, 11, 9, 10, 7, 8, 6, 7, 4, 5, 3, 4, 1, 2, 0, 1));
+		t0 = _mm256_and_si256(v, _mm256_set1_epi32(0x0fc0fc00));
+		t1 = _mm256_mulhi_epu16(t0, _mm256_set1_epi32(0x04000040));
+		t2 = _mm256_and_si256(v, _mm256_set1_epi32(0x003f03f0));
+		t3 = _mm256_mullo_epi16(t2, _mm256_set1_epi32(0x01000010));
+		v = _mm256_or_si256(t1, t3);
+
+		r = _mm256_subs_epu8(v, _mm256_set1_epi8(51));
+		r = _mm256_or_si256(r, _mm256_and_si256(
+				_mm256_cmpgt_epi8(_mm256_set1_epi8(26), v),
+				_mm256_set1_epi8(13)));
+		v = _mm256_add_epi8(v, _mm256_shuffle_epi8(lut, r));
+		_mm256_storeu_si256((__m256i*)out, v);
+	}
+	return i;
+}
+
+#endif	/* x86 */
+
+unsigned int base64_encode(
+		const unsigned char *in,
+		unsigned int len,
+		char *out,
+		int flags)
+{
+	const char *cvt = alphabet[(flags & base64_url) != 0];
+	unsigned int i = 0, n;
+	char *p = out;
+
+#ifdef HAVE_SIMD_BASE64
+	if(__builtin_cpu_supports("avx2"))
+		i = encode_avx2(in, len, p, flags & base64_url);
+	else if(__builtin_cpu_supports("ssse3"))
+		i = encode_ssse3(in, len, p, flags & base64_url);
+	p += i / 3 * 4;
+#endif
+	n = encode_scalar(in + i, len - i, p, cvt);
+	i += n;
+	p += n / 3 * 4;
+
+	/* the last 1 or 2 bytes */
+	if(i < len) {
+		*p++ = cvt[in[i] >> 2];
+		if(i + 1 < len) {
+			*p++ = cvt[((in[i] & 0x03) << 4) | (in[i+1] >> 4)];
+			*p++ = cvt[(in[i+1] & 0x0f) << 2];
+		} else {
+			*p++ = cvt[(in[i] & 0x03) << 4];
+			if(!(flags & base64_nopad))
+				*p++ = '=';
+		}
+		if(!(flags & base64_nopad))
+			*p++ = '=';
+	}
+	*p = 0;
+	return p - out;
+}
@@ -0,0 +1,60 @@
+/*
+  base64.h - base64 and base64url encoder
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef BASE64_H__
+#define BASE64_H__
+
+/**
+ * @file
+ * Base64 encoding of RFC 4648, with the standard and the URL-safe
+ * alphabets and optional padding. On x86 CPUs with AVX2 or SSSE3 the bulk
+ * of the input is encoded 24 or 12 bytes per step with vector shuffles
+ * (chosen at run time); the tail and other CPUs use a table-driven scalar
+ * loop.
+ */
+
+/** Variant flags for base64_encode. */
+enum base64_flags {
+	base64_url = 1,		/**< "-_" instead of "+/" (base64url) */
+	base64_nopad = 2	/**< omit the trailing '=' characters */
+};
+
+/**
+ * @return	Number of characters base64_encode produces for \e len bytes,
+ * 			without the terminating 0.
+ */
+unsigned long long base64_length(unsigned long long len, int flags);
+
+/**
+ * Encode \e len bytes of \e in into \e out, which must have room for
+ * base64_length() characters plus the terminating 0.
+ *
+ * @return	Number of characters written, without the terminating 0.
+ */
+unsigned int base64_encode(
+		const unsigned char *in,
+		unsigned int len,
+		char *out,
+		int flags);
+
+#endif	/* BASE64_H__ */
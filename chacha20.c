@@ -0,0 +1,382 @@
+/*
+  chacha20.c - ChaCha20 keystream generator with fast key erasure
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <string.h>
+#include <stdint.h>
+#include "chacha20.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define	HAVE_X86_SIMD
+#endif
+
+/**
+ * @file
+ * ChaCha20 block function (RFC 7539 layout, 32-bit counter and all-zero
+ * nonce; the key is never reused across refills so the nonce is not needed)
+ * with scalar, SSE2 (4 blocks) and AVX2 (8 blocks) cores. The widest core
+ * supported by the CPU is selected at run-time on first use.
+ */
+
+typedef void (*blocks_fn)(unsigned char*, const uint32_t*, uint32_t,
+		unsigned int);
+
+static const uint32_t sigma[4] = {
+	0x61707865, 0x3320646e, 0x79622d32, 0x6b206574
+};
+
+#define	ROTL32(v, n) (((v) << (n)) | ((v) >> (32 - (n))))
+
+#define	QR(a, b, c, d) do { \
+	a += b; d ^= a; d = ROTL32(d, 16); \
+	c += d; b ^= c; b = ROTL32(b, 12); \
+	a += b; d ^= a; d = ROTL32(d,  8); \
+	c += d; b ^= c; b = ROTL32(b,  7); \
+} while(0)
+
+static uint32_t load32_le(const unsigned char *p)
+{
+	return (uint32_t)p[0] | ((uint32_t)p[1] << 8)
+		| ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static void store32_le(unsigned char *p, uint32_t v)
+{
+	p[0] = v; p[1] = v >> 8; p[2] = v >> 16; p[3] = v >> 24;
+}
+
+/*
+ * Generate nblocks keystream blocks with consecutive counters starting at
+ * counter into out.
+ */
+static void blocks_scalar(
+		unsigned char *out,
+		const uint32_t *key,
+		uint32_t counter,
+		unsigned int nblocks)
+{
+	uint32_t in[16], x[16];
+	unsigned int i;
+
+	memcpy(in, sigma, sizeof(sigma));
+	memcpy(in+4, key, 8*sizeof(*key));
+	in[12] = counter;
+	in[13] = in[14] = in[15] = 0;
+
+	for(; nblocks; nblocks--) {
+		memcpy(x, in, sizeof(x));
+		for(i = 0; i < 10; i++) {
+			QR(x[0], x[4], x[ 8], x[12]);
+			QR(x[1], x[5], x[ 9], x[13]);
+			QR(x[2], x[6], x[10], x[14]);
+			QR(x[3], x[7], x[11], x[15]);
+			QR(x[0], x[5], x[10], x[15]);
+			QR(x[1], x[6], x[11], x[12]);
+			QR(x[2], x[7], x[ 8], x[13]);
+			QR(x[3], x[4], x[ 9], x[14]);
+		}
+		for(i = 0; i < 16; i++)
+			store32_le(out + 4*i, x[i] + in[i]);
+		in[12]++;
+		out += CHACHA20_BLOCK_SIZE;
+	}
+
+	memset(in, 0, sizeof(in));
+	memset(x, 0, sizeof(x));
+}
+
+#ifdef HAVE_X86_SIMD
+/*
+ * The vectorized cores keep state word i of N consecutive blocks in lane
+ * 0..N-1 of x[i]. After the rounds each group of four state words is
+ * transposed back into block order with unpack instructions.
+ */
+#define	DOUBLE_ROUND(QRV) do { \
+	QRV(x[0], x[4], x[ 8], x[12]); \
+	QRV(x[1], x[5], x[ 9], x[13]); \
+	QRV(x[2], x[6], x[10], x[14]); \
+	QRV(x[3], x[7], x[11], x[15]); \
+	QRV(x[0], x[5], x[10], x[15]); \
+	QRV(x[1], x[6], x[11], x[12]); \
+	QRV(x[2], x[7], x[ 8], x[13]); \
+	QRV(x[3], x[4], x[ 9], x[14]); \
+} while(0)
+
+#define	ROTL128(v, n) \
+	_mm_or_si128(_mm_slli_epi32(v, n), _mm_srli_epi32(v, 32 - (n)))
+
+#define	QR128(a, b, c, d) do { \
+	a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = ROTL128(d, 16); \
+	c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = ROTL128(b, 12); \
+	a = _mm_add_epi32(a, b); d = _mm_xor_si128(d, a); d = ROTL128(d,  8); \
+	c = _mm_add_epi32(c, d); b = _mm_xor_si128(b, c); b = ROTL128(b,  7); \
+} while(0)
+
+__attribute__((target("sse2")))
+static void blocks_sse2(
+		unsigned char *out,
+		const uint32_t *key,
+		uint32_t counter,
+		unsigned int nblocks)
+{
+	__m128i x[16], in[16], t0, t1, t2, t3;
+	unsigned int i, g;
+
+	for(i = 0; i < 4; i++)
+		in[i] = _mm_set1_epi32(sigma[i]);
+	for(i = 0; i < 8; i++)
+		in[4+i] = _mm_set1_epi32(key[i]);
+	in[13] = in[14] = in[15] = _mm_setzero_si128();
+
+	for(; nblocks >= 4; nblocks -= 4) {
+		in[12] = _mm_add_epi32(_mm_set1_epi32(counter),
+				_mm_set_epi32(3, 2, 1, 0));
+		memcpy(x, in, sizeof(x));
+		for(i = 0; i < 10; i++)
+			DOUBLE_ROUND(QR128);
+
+		for(g = 0; g < 4; g++) {
+			__m128i a = _mm_add_epi32(x[4*g+0], in[4*g+0]);
+			__m128i b = _mm_add_epi32(x[4*g+1], in[4*g+1]);
+			__m128i c = _mm_add_epi32(x[4*g+2], in[4*g+2]);
+			__m128i d = _mm_add_epi32(x[4*g+3], in[4*g+3]);
+
+			t0 = _mm_unpacklo_epi32(a, b);
+			t1 = _mm_unpacklo_epi32(c, d);
+			t2 = _mm_unpackhi_epi32(a, b);
+			t3 = _mm_unpackhi_epi32(c, d);
+			_mm_storeu_si128((__m128i*)(out + 0*64 + 16*g),
+					_mm_unpacklo_epi64(t0, t1));
+			_mm_storeu_si128((__m128i*)(out + 1*64 + 16*g),
+					_mm_unpackhi_epi64(t0, t1));
+			_mm_storeu_si128((__m128i*)(out + 2*64 + 16*g),
+					_mm_unpacklo_epi64(t2, t3));
+			_mm_storeu_si128((__m128i*)(out + 3*64 + 16*g),
+					_mm_unpackhi_epi64(t2, t3));
+		}
+		counter += 4;
+		out += 4*CHACHA20_BLOCK_SIZE;
+	}
+
+	memset(x, 0, sizeof(x));
+	memset(in, 0, sizeof(in));
+	if(nblocks)
+		blocks_scalar(out, key, counter, nblocks);
+}
+
+#define	ROTL256(v, n) \
+	_mm256_or_si256(_mm256_slli_epi32(v, n), _mm256_srli_epi32(v, 32 - (n)))
+
+#define	QR256(a, b, c, d) do { \
+	a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); \
+	d = _mm256_shuffle_epi8(d, rot16); \
+	c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); \
+	b = ROTL256(b, 12); \
+	a = _mm256_add_epi32(a, b); d = _mm256_xor_si256(d, a); \
+	d = _mm256_shuffle_epi8(d, rot8); \
+	c = _mm256_add_epi32(c, d); b = _mm256_xor_si256(b, c); \
+	b = ROTL256(b, 7); \
+} while(0)
+
+__attribute__((target("avx2")))
+static void blocks_avx2(
+		unsigned char *out,
+		const uint32_t *key,
+		uint32_t counter,
+		unsigned int nblocks)
+{
+	__m256i x[16], in[16], t0, t1, t2, t3, r;
+	const __m256i rot16 = _mm256_set_epi8(
+			13,12,15,14, 9,8,11,10, 5,4,7,6, 1,0,3,2,
+			13,12,15,14, 9,8,11,10, 5,4,7,6, 1,0,3,2);
+	const __m256i rot8 = _mm256_set_epi8(
+			14,13,12,15, 10,9,8,11, 6,5,4,7, 2,1,0,3,
+			14,13,12,15, 10,9,8,11, 6,5,4,7, 2,1,0,3);
+	unsigned int i, g;
+
+	for(i = 0; i < 4; i++)
+		in[i] = _mm256_set1_epi32(sigma[i]);
+	for(i = 0; i < 8; i++)
+		in[4+i] = _mm256_set1_epi32(key[i]);
+	in[13] = in[14] = in[15] = _mm256_setzero_si256();
+
+	for(; nblocks >= 8; nblocks -= 8) {
+		in[12] = _mm256_add_epi32(_mm256_set1_epi32(counter),
+				_mm256_set_epi32(7, 6, 5, 4, 3, 2, 1, 0));
+		memcpy(x, in, sizeof(x));
+		for(i = 0; i < 10; i++)
+			DOUBLE_ROUND(QR256);
+
+		/*
+		 * unpack works within 128-bit lanes, so the low lane yields blocks
+		 * 0-3 and the high lane blocks 4-7.
+		 */
+		for(g = 0; g < 4; g++) {
+			__m256i a = _mm256_add_epi32(x[4*g+0], in[4*g+0]);
+			__m256i b = _mm256_add_epi32(x[4*g+1], in[4*g+1]);
+			__m256i c = _mm256_add_epi32(x[4*g+2], in[4*g+2]);
+			__m256i d = _mm256_add_epi32(x[4*g+3], in[4*g+3]);
+
+			t0 = _mm256_unpacklo_epi32(a, b);
+			t1 = _mm256_unpacklo_epi32(c, d);
+			t2 = _mm256_unpackhi_epi32(a, b);
+			t3 = _mm256_unpackhi_epi32(c, d);
+
+#define	STORE_PAIR(blk, v) do { \
+	r = (v); \
+	_mm_storeu_si128((__m128i*)(out + (blk)*64 + 16*g), \
+			_mm256_castsi256_si128(r)); \
+	_mm_storeu_si128((__m128i*)(out + ((blk)+4)*64 + 16*g), \
+			_mm256_extracti128_si256(r, 1)); \
+} while(0)
+			STORE_PAIR(0, _mm256_unpacklo_epi64(t0, t1));
+			STORE_PAIR(1, _mm256_unpackhi_epi64(t0, t1));
+			STORE_PAIR(2, _mm256_unpacklo_epi64(t2, t3));
+			STORE_PAIR(3, _mm256_unpackhi_epi64(t2, t3));
+#undef	STORE_PAIR
+		}
+		counter += 8;
+		out += 8*CHACHA20_BLOCK_SIZE;
+	}
+
+	memset(x, 0, sizeof(x));
+	memset(in, 0, sizeof(in));
+	if(nblocks)
+		blocks_sse2(out, key, counter, nblocks);
+}
+#endif	/* HAVE_X86_SIMD */
+
+static blocks_fn chacha20_blocks;
+
+static void select_core(void)
+{
+	chacha20_blocks = blocks_scalar;
+#ifdef HAVE_X86_SIMD
+	__builtin_cpu_init();
+	if(__builtin_cpu_supports("avx2"))
+		chacha20_blocks = blocks_avx2;
+	else if(__builtin_cpu_supports("sse2"))
+		chacha20_blocks = blocks_sse2;
+#endif
+}
+
+static void load_key(const unsigned char *bytes, uint32_t *key)
+{
+	unsigned int i;
+
+	for(i = 0; i < 8; i++)
+		key[i] = load32_le(bytes + 4*i);
+}
+
+/*
+ * Run ChaCha20 under the current key (buf[0..31]) and write keystream
+ * blocks 0..CHACHA20_RNG_BLOCKS-1 over the buffer. The first
+ * CHACHA20_KEY_SIZE bytes thereby become the next key.
+ */
+static void refill(struct chacha20_rng *r)
+{
+	uint32_t key[8];
+
+	load_key(r->buf, key);
+	chacha20_blocks(r->buf, key, 0, CHACHA20_RNG_BLOCKS);
+	r->idx = CHACHA20_KEY_SIZE;
+	memset(key, 0, sizeof(key));
+}
+
+void chacha20_rng_init(struct chacha20_rng *r, const unsigned char *key)
+{
+	if(!chacha20_blocks)
+		select_core();
+
+	memset(r->buf, 0, sizeof(r->buf));
+	memcpy(r->buf, key, CHACHA20_KEY_SIZE);
+	r->idx = CHACHA20_RNG_BUFSIZE;
+}
+
+void chacha20_rng_reseed(struct chacha20_rng *r, const unsigned char *seed)
+{
+	unsigned char key[CHACHA20_KEY_SIZE];
+	unsigned int i;
+
+	/* SECURITY NOTE: the new key passes through the stack. */
+	chacha20_rng_bytes(r, key, sizeof(key));
+	for(i = 0; i < sizeof(key); i++)
+		key[i] ^= seed[i];
+	chacha20_rng_init(r, key);
+	memset(key, 0, sizeof(key));
+}
+
+void chacha20_rng_bytes(struct chacha20_rng *r, void *buf, unsigned int n)
+{
+	unsigned char *out = buf;
+	unsigned int chunk;
+
+	while(n) {
+		if(r->idx == CHACHA20_RNG_BUFSIZE) {
+			/*
+			 * Large requests are served straight from the cipher. The
+			 * blocks use counters past the ones used by refill(), so the
+			 * key is still used exactly once for every counter value.
+			 */
+			if(n >= CHACHA20_BLOCK_SIZE) {
+				uint32_t key[8];
+
+				chunk = n / CHACHA20_BLOCK_SIZE;
+				load_key(r->buf, key);
+				chacha20_blocks(out, key, CHACHA20_RNG_BLOCKS, chunk);
+				memset(key, 0, sizeof(key));
+				chunk *= CHACHA20_BLOCK_SIZE;
+				out += chunk; n -= chunk;
+			}
+			refill(r);
+			continue;
+		}
+
+		chunk = CHACHA20_RNG_BUFSIZE - r->idx;
+		if(chunk > n)
+			chunk = n;
+		memcpy(out, r->buf + r->idx, chunk);
+		memset(r->buf + r->idx, 0, chunk);
+		r->idx += chunk; out += chunk; n -= chunk;
+	}
+}
+
+void chacha20_rng_destroy(struct chacha20_rng *r)
+{
+	memset(r, 0, sizeof(*r));
+}
+
+void chacha20_block(
+		const unsigned char *key,
+		unsigned int counter,
+		unsigned char *out)
+{
+	uint32_t k[8];
+
+	if(!chacha20_blocks)
+		select_core();
+
+	load_key(key, k);
+	chacha20_blocks(out, k, counter, 1);
+	memset(k, 0, sizeof(k));
+}
@@ -0,0 +1,79 @@
+/*
+  chacha20.h - ChaCha20 keystream generator with fast key erasure
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CHACHA20_H__
+#define CHACHA20_H__
+
+/**
+ * @file
+ * A self-contained ChaCha20 keystream generator used by the SRNG backends
+ * that do not rely on the crypto library for bulk output.
+ *
+ * The generator follows the "fast key erasure" construction: every refill
+ * runs ChaCha20 over a fresh key for a fixed number of blocks, the first
+ * CHACHA20_KEY_SIZE bytes of the output become the next key and the rest is
+ * handed out. Handed out bytes are zeroed immediately, so a compromise of
+ * the state never reveals past output.
+ */
+
+#define	CHACHA20_KEY_SIZE	32
+#define	CHACHA20_BLOCK_SIZE	64
+
+/** Number of blocks generated per refill; a multiple of the widest core. */
+#define	CHACHA20_RNG_BLOCKS	16
+#define	CHACHA20_RNG_BUFSIZE	(CHACHA20_RNG_BLOCKS*CHACHA20_BLOCK_SIZE)
+
+struct chacha20_rng {
+	/* buf[0..CHACHA20_KEY_SIZE-1] is the key, the rest is keystream */
+	unsigned char buf[CHACHA20_RNG_BUFSIZE];
+	unsigned int idx;	/* next unused keystream byte */
+};
+
+/**
+ * Initialize the generator with \e key of CHACHA20_KEY_SIZE bytes. The key
+ * is copied, so the caller should wipe its copy.
+ */
+void chacha20_rng_init(struct chacha20_rng *r, const unsigned char *key);
+
+/**
+ * Replace the key by the next CHACHA20_KEY_SIZE bytes of keystream XORed
+ * with \e seed of CHACHA20_KEY_SIZE bytes.
+ */
+void chacha20_rng_reseed(struct chacha20_rng *r, const unsigned char *seed);
+
+/** Obtain \e n bytes of keystream. */
+void chacha20_rng_bytes(struct chacha20_rng *r, void *buf, unsigned int n);
+
+/** Zero the generator state. */
+void chacha20_rng_destroy(struct chacha20_rng *r);
+
+/**
+ * Compute keystream block number \e counter under \e key (CHACHA20_KEY_SIZE
+ * bytes) into \e out (CHACHA20_BLOCK_SIZE bytes). Used for key derivation.
+ */
+void chacha20_block(
+		const unsigned char *key,
+		unsigned int counter,
+		unsigned char *out);
+
+#endif	/* CHACHA20_H__ */
@@ -0,0 +1,135 @@
+/*
+  cpu_random.c - mixing of the CPU's random number instructions into seeds
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <string.h>
+#include "cpu_random.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+
+#include <pthread.h>
+#include <cpuid.h>
+
+/*
+ * Retry budgets. RDRAND fails only if the DRNG is under heavy contention,
+ * and Intel recommends giving up after 10 tries. RDSEED is expected to run
+ * dry under load, so it gets more tries with a pause in between before we
+ * fall back to RDRAND. In VMs both may fail for long stretches.
+ */
+#define	RDRAND_RETRIES	10
+#define	RDSEED_RETRIES	100
+
+static pthread_once_t detect_once = PTHREAD_ONCE_INIT;
+static int have_rdrand, have_rdseed;
+
+static int rdrand_step(unsigned long *v)
+{
+	unsigned char ok;
+
+	__asm__ __volatile__("rdrand %0; setc %1" : "=r" (*v), "=qm" (ok) : : "cc");
+	return ok;
+}
+
+static int rdseed_step(unsigned long *v)
+{
+	unsigned char ok;
+
+	__asm__ __volatile__("rdseed %0; setc %1" : "=r" (*v), "=qm" (ok) : : "cc");
+	return ok;
+}
+
+static int rdrand(unsigned long *v)
+{
+	int i;
+
+	for(i = 0; i < RDRAND_RETRIES; i++)
+		if(rdrand_step(v))
+			return 1;
+	return 0;
+}
+
+static int rdseed(unsigned long *v)
+{
+	int i;
+
+	for(i = 0; i < RDSEED_RETRIES; i++) {
+		if(rdseed_step(v))
+			return 1;
+		__asm__ __volatile__("pause");
+	}
+	return 0;
+}
+
+static void detect(void)
+{
+	unsigned int eax, ebx, ecx, edx;
+	unsigned long v1, v2;
+
+	if(__get_cpuid(1, &eax, &ebx, &ecx, &edx))
+		have_rdrand = (ecx >> 30) & 1;
+	if(__get_cpuid_max(0, NULL) >= 7) {
+		__cpuid_count(7, 0, eax, ebx, ecx, edx);
+		have_rdseed = (ebx >> 18) & 1;
+	}
+
+	/*
+	 * Some CPUs advertise RDRAND but return a constant (all ones after a
+	 * resume on certain AMD parts) while reporting success.
+	 */
+	if(have_rdrand && (!rdrand(&v1) || !rdrand(&v2) || v1 == v2))
+		have_rdrand = have_rdseed = 0;
+	v1 = v2 = 0;
+}
+
+unsigned int cpu_random_mix(unsigned char *buf, unsigned int n)
+{
+	unsigned long v, prev = 0;
+	unsigned int i, k;
+
+	pthread_once(&detect_once, detect);
+	if(!have_rdrand && !have_rdseed)
+		return 0;
+
+	for(i = 0; i < n; ) {
+		if(!(have_rdseed && rdseed(&v)) && !(have_rdrand && rdrand(&v)))
+			break;
+		/* a stuck generator is as good as a missing one */
+		if(i && v == prev)
+			break;
+		prev = v;
+
+		for(k = 0; k < sizeof(v) && i < n; k++, i++)
+			buf[i] ^= ((unsigned char*)&v)[k];
+	}
+
+	v = prev = 0;
+	return i;
+}
+
+#else
+
+unsigned int cpu_random_mix(unsigned char *buf, unsigned int n)
+{
+	return 0;
+}
+
+#endif
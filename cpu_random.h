@@ -0,0 +1,44 @@
+/*
+  cpu_random.h - mixing of the CPU's random number instructions into seeds
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef CPU_RANDOM_H__
+#define CPU_RANDOM_H__
+
+/**
+ * @file
+ * RDSEED and RDRAND on x86 CPUs that have them, detected at run time with
+ * CPUID. Their output is only ever XORed into seed material that already
+ * came from the operating system, so a missing, failing or untrustworthy
+ * instruction can never make a seed weaker than it was.
+ */
+
+/**
+ * XOR \e n bytes of RDSEED (or, if that runs out of its retry budget,
+ * RDRAND) output into \e buf. Does nothing on other CPUs.
+ *
+ * @return Number of bytes mixed in; less than \e n if the instructions
+ *         are missing or failed, in which case \e buf is still usable.
+ */
+unsigned int cpu_random_mix(unsigned char *buf, unsigned int n);
+
+#endif	/* CPU_RANDOM_H__ */
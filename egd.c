@@ -0,0 +1,186 @@
+/*
+  egd.c - seeding from an entropy gathering daemon
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include "egd.h"
+
+/* Time allowed for connecting and reading the whole request. */
+#ifndef EGD_TIMEOUT
+#define	EGD_TIMEOUT	5000
+#endif
+
+/* EGD command: read entropy, blocking until the requested count is there */
+#define	EGD_READ_BLOCKING	0x02
+
+/* The count in a request is one byte. */
+#define	EGD_MAX_REQUEST		255
+
+#ifndef MSG_NOSIGNAL
+#define	MSG_NOSIGNAL		0
+#endif
+
+long long egd_now_ms(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec * 1000LL + ts.tv_nsec / 1000000;
+}
+
+/*
+ * The helpers below return -1 with errno set on error, errno is ETIMEDOUT
+ * if the deadline has passed.
+ */
+
+static int wait_fd(int fd, short events, long long deadline)
+{
+	struct pollfd pfd;
+	long long left;
+	int ret;
+
+	for(;;) {
+		if((left = deadline - egd_now_ms()) <= 0) {
+			errno = ETIMEDOUT;
+			return -1;
+		}
+		pfd.fd = fd;
+		pfd.events = events;
+		pfd.revents = 0;
+		if((ret = poll(&pfd, 1, (int)left)) > 0)
+			return 0;
+		if(ret < 0 && errno != EINTR)
+			return -1;
+	}
+}
+
+static int connect_socket(int fd, const struct sockaddr_un *addr, long long deadline)
+{
+	socklen_t len = sizeof(int);
+	int err;
+
+	for(;;) {
+		if(!connect(fd, (const struct sockaddr*)addr, sizeof(*addr)))
+			return 0;
+		if(errno == EINPROGRESS)
+			break;
+		if(errno != EAGAIN && errno != EINTR)
+			return -1;
+		/* the daemon's backlog is full: retry shortly */
+		if(egd_now_ms() >= deadline) {
+			errno = ETIMEDOUT;
+			return -1;
+		}
+		poll(NULL, 0, 10);
+	}
+
+	if(wait_fd(fd, POLLOUT, deadline) < 0)
+		return -1;
+	if(getsockopt(fd, SOL_SOCKET, SO_ERROR, &err, &len) < 0)
+		return -1;
+	if(err) {
+		errno = err;
+		return -1;
+	}
+	return 0;
+}
+
+static int transfer(int fd, unsigned char *buf, unsigned int n, int sending,
+	long long deadline)
+{
+	ssize_t ret;
+
+	while(n) {
+		if(sending)
+			ret = send(fd, buf, n, MSG_NOSIGNAL);
+		else
+			ret = recv(fd, buf, n, 0);
+
+		if(ret > 0) {
+			buf += ret; n -= ret;
+		} else if(!ret) {
+			errno = ECONNRESET;
+			return -1;
+		} else if(errno == EAGAIN || errno == EWOULDBLOCK) {
+			if(wait_fd(fd, sending ? POLLOUT : POLLIN, deadline) < 0)
+				return -1;
+		} else if(errno != EINTR) {
+			return -1;
+		}
+	}
+	return 0;
+}
+
+int egd_read(const char *path, unsigned char *buf, unsigned int n)
+{
+	long long deadline = egd_now_ms() + EGD_TIMEOUT;
+	struct sockaddr_un addr;
+	unsigned char request[2];
+	unsigned int chunk;
+	int fd;
+
+	if(strlen(path) >= sizeof(addr.sun_path)) {
+		fprintf(stderr, "WARNING: EGD socket path %s is too long.\n", path);
+		return -1;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, path);
+
+	if((fd = socket(AF_UNIX, SOCK_STREAM, 0)) < 0) {
+		perror("socket");
+		return -1;
+	}
+	if(fcntl(fd, F_SETFL, O_NONBLOCK) < 0
+	|| connect_socket(fd, &addr, deadline) < 0)
+		goto error;
+
+	while(n) {
+		chunk = n < EGD_MAX_REQUEST ? n : EGD_MAX_REQUEST;
+		request[0] = EGD_READ_BLOCKING;
+		request[1] = chunk;
+		if(transfer(fd, request, sizeof(request), 1, deadline) < 0
+		|| transfer(fd, buf, chunk, 0, deadline) < 0)
+			goto error;
+		buf += chunk; n -= chunk;
+	}
+
+	close(fd);
+	return 0;
+
+error:
+	if(errno == ETIMEDOUT)
+		fprintf(stderr, "WARNING: EGD socket %s: no answer within %d ms.\n",
+				path, EGD_TIMEOUT);
+	else
+		perror(path);
+	close(fd);
+	return -1;
+}
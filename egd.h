@@ -0,0 +1,50 @@
+/*
+  egd.h - seeding from an entropy gathering daemon
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef EGD_H__
+#define EGD_H__
+
+/**
+ * @file
+ * A client for the EGD (entropy gathering daemon) protocol, for systems
+ * without a usable /dev/urandom. All socket I/O is non-blocking and bound
+ * by a deadline of EGD_TIMEOUT milliseconds per call, so a stuck daemon
+ * can delay the program but not hang it.
+ */
+
+/**
+ * Read \e n bytes of entropy from the EGD listening on the UNIX socket
+ * \e path.
+ *
+ * @return 0 on success. On error or timeout a warning is printed and -1
+ *         is returned; \e buf may then hold a partial answer.
+ */
+int egd_read(const char *path, unsigned char *buf, unsigned int n);
+
+/**
+ * The monotonic clock in milliseconds, for deadlines such as EGD_TIMEOUT.
+ * The hardware RNG reads of seed.c share it.
+ */
+long long egd_now_ms(void);
+
+#endif	/* EGD_H__ */
@@ -0,0 +1,192 @@
+/*
+  encode.c - text encodings of random bytes
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <string.h>
+#include <pthread.h>
+#include "encode.h"
+#include "base64.h"
+
+/* The two hex digits of every byte value. */
+static const char hex_pairs[513] =
+	"000102030405060708090a0b0c0d0e0f101112131415161718191a1b1c1d1e1f"
+	"202122232425262728292a2b2c2d2e2f303132333435363738393a3b3c3d3e3f"
+	"404142434445464748494a4b4c4d4e4f505152535455565758595a5b5c5d5e5f"
+	"606162636465666768696a6b6c6d6e6f707172737475767778797a7b7c7d7e7f"
+	"808182838485868788898a8b8c8d8e8f909192939495969798999a9b9c9d9e9f"
+	"a0a1a2a3a4a5a6a7a8a9aaabacadaeafb0b1b2b3b4b5b6b7b8b9babbbcbdbebf"
+	"c0c1c2c3c4c5c6c7c8c9cacbcccdcecfd0d1d2d3d4d5d6d7d8d9dadbdcdddedf"
+	"e0e1e2e3e4e5e6e7e8e9eaebecedeeeff0f1f2f3f4f5f6f7f8f9fafbfcfdfeff";
+
+static const char base32_alphabet[2][33] = {
+	"ABCDEFGHIJKLMNOPQRSTUVWXYZ234567",
+	"0123456789ABCDEFGHJKMNPQRSTVWXYZ"	/* Crockford */
+};
+
+static const char z85_alphabet[86] =
+	"0123456789abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ"
+	".-:+=^!/*?&<>()[]{}@%$#";
+
+/*
+ * The two characters of every 10-bit value in both base32 alphabets, so
+ * that a group of 5 bytes takes 4 lookups; filled on first use.
+ */
+static char base32_pairs[2][2048];
+static pthread_once_t base32_pairs_once = PTHREAD_ONCE_INIT;
+
+static void base32_pairs_init(void)
+{
+	unsigned int a, i;
+
+	for(a = 0; a < 2; a++)
+		for(i = 0; i < 1024; i++) {
+			base32_pairs[a][2*i] = base32_alphabet[a][i >> 5];
+			base32_pairs[a][2*i+1] = base32_alphabet[a][i & 31];
+		}
+}
+
+/* Characters of base32 for a tail of 0 to 4 bytes. */
+static const unsigned char base32_tail[5] = { 0, 2, 4, 5, 7 };
+
+unsigned long long encode_input_length(enum encoding encoding,
+		unsigned long long len)
+{
+	if(encoding == encoding_z85)
+		return (len + 3) & ~3ULL;
+	return len;
+}
+
+unsigned long long encode_length(enum encoding encoding,
+		unsigned long long len, int flags)
+{
+	switch(encoding) {
+	case encoding_hex:
+		return len * 2;
+	case encoding_base32:
+		if(!(flags & base64_nopad))
+			return (len + 4) / 5 * 8;
+		/* fall through */
+	case encoding_crockford:
+		return len / 5 * 8 + base32_tail[len % 5];
+	case encoding_z85:
+		return len / 4 * 5;
+	default:
+		return base64_length(len, flags);
+	}
+}
+
+static unsigned int hex_encode(const unsigned char *in, unsigned int len,
+		char *out)
+{
+	unsigned int i;
+
+	for(i = 0; i < len; i++)
+		memcpy(out + 2*i, hex_pairs + 2*in[i], 2);
+	out[2*len] = 0;
+	return 2 * len;
+}
+
+/* Encode one group of 5 bytes into 8 characters. */
+static void base32_group(const unsigned char *in, char *out, const char *pairs)
+{
+	unsigned long long v;
+	unsigned int i;
+
+	v = (unsigned long long)in[0] << 32 | (unsigned long)in[1] << 24
+		| in[2] << 16 | in[3] << 8 | in[4];
+	for(i = 0; i < 4; i++)
+		memcpy(out + 2*i, pairs + 2 * ((v >> (30 - 10*i)) & 1023), 2);
+}
+
+static unsigned int base32_encode(const unsigned char *in, unsigned int len,
+		char *out, const char *pairs, int pad)
+{
+	unsigned char last[5] = { 0, 0, 0, 0, 0 };
+	char tail[8];
+	char *p = out;
+	unsigned int i, n;
+
+	for(; len >= 5; in += 5, len -= 5, p += 8)
+		base32_group(in, p, pairs);
+
+	if(len) {
+		/*
+		 * The tail is encoded as a group padded with 0 bits in a buffer of
+		 * its own, so that only the characters that belong to the output
+		 * are written to it.
+		 */
+		memcpy(last, in, len);
+		base32_group(last, tail, pairs);
+		n = base32_tail[len];
+		for(i = n; i < 8; i++)
+			tail[i] = '=';
+		n = pad ? 8 : n;
+		memcpy(p, tail, n);
+		p += n;
+		memset(last, 0, sizeof(last));
+		memset(tail, 0, sizeof(tail));
+	}
+	*p = 0;
+	return p - out;
+}
+
+static unsigned int z85_encode(const unsigned char *in, unsigned int len,
+		char *out)
+{
+	unsigned int v;
+	char *p = out;
+	int i;
+
+	for(; len >= 4; in += 4, len -= 4, p += 5) {
+		v = (unsigned int)in[0] << 24 | in[1] << 16 | in[2] << 8 | in[3];
+		for(i = 4; i >= 0; i--) {
+			p[i] = z85_alphabet[v % 85];
+			v /= 85;
+		}
+	}
+	*p = 0;
+	return p - out;
+}
+
+unsigned int encode(
+		enum encoding encoding,
+		const unsigned char *in,
+		unsigned int len,
+		char *out,
+		int flags)
+{
+	switch(encoding) {
+	case encoding_hex:
+		return hex_encode(in, len, out);
+	case encoding_base32:
+		pthread_once(&base32_pairs_once, base32_pairs_init);
+		return base32_encode(in, len, out, base32_pairs[0],
+				!(flags & base64_nopad));
+	case encoding_crockford:
+		pthread_once(&base32_pairs_once, base32_pairs_init);
+		return base32_encode(in, len, out, base32_pairs[1], 0);
+	case encoding_z85:
+		return z85_encode(in, len, out);
+	default:
+		return base64_encode(in, len, out, flags);
+	}
+}
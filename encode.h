@@ -0,0 +1,77 @@
+/*
+  encode.h - text encodings of random bytes
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef ENCODE_H__
+#define ENCODE_H__
+
+/**
+ * @file
+ * Text encodings for the raw random method: base64 (see base64.h), hex,
+ * base32 in the RFC 4648 and Crockford alphabets, and Z85. Except for
+ * base64, each one is a table-driven scalar loop that works on whole
+ * groups of input bytes (5 bytes for base32, 4 for Z85) held in one
+ * integer.
+ */
+
+/** Encodings known to encode(). */
+enum encoding {
+	encoding_base64,	/**< RFC 4648 base64, see base64.h */
+	encoding_hex,		/**< lower-case hexadecimal */
+	encoding_base32,	/**< RFC 4648 base32, "A-Z2-7" */
+	encoding_crockford,	/**< Crockford's base32, "0-9A-Z" without ILOU,
+							 never padded */
+	encoding_z85		/**< ZeroMQ Z85, 4 bytes to 5 characters */
+};
+
+/**
+ * @return	Number of bytes to encode so that at least \e len are encoded:
+ * 			Z85 takes whole groups of 4 bytes, the others any length.
+ */
+unsigned long long encode_input_length(enum encoding encoding,
+		unsigned long long len);
+
+/**
+ * @param	flags	base64_url for base64; base64_nopad for base64 and
+ * 					RFC 4648 base32 (see base64.h).
+ * @return	Number of characters encode() produces for \e len bytes,
+ * 			without the terminating 0.
+ */
+unsigned long long encode_length(enum encoding encoding,
+		unsigned long long len, int flags);
+
+/**
+ * Encode \e len bytes of \e in into \e out, which must have room for
+ * encode_length() characters plus the terminating 0. For Z85, \e len
+ * must be a multiple of 4. Only the last call on a stream may encode a
+ * \e len that is not a multiple of 60, since that can add padding.
+ *
+ * @return	Number of characters written, without the terminating 0.
+ */
+unsigned int encode(
+		enum encoding encoding,
+		const unsigned char *in,
+		unsigned int len,
+		char *out,
+		int flags);
+
+#endif	/* ENCODE_H__ */
@@ -32,12 +32,20 @@ enum exception_code {
 	no_exception = 0,	/* used to exit the Try block */
 	out_of_memory_exception,
 	system_call_failed_exception,
+	output_overflow_exception,	/* see struct pwgen_output */
 
 	/* library exceptions */
-	lib_crypto_exception
+	lib_crypto_exception,
+
+	/* the generator can't take the requested seed (EGD, seed file) */
+	seed_exception,
+
+	/* seed material failed a health test */
+	rng_health_exception
 };
 
 define_exception_type(enum exception_code);
-extern struct exception_context *the_exception_context;
+/* per thread, so that a thread can Throw without touching the others */
+extern __thread struct exception_context *the_exception_context;
 
 #endif	/* EXCEPTIONS_H__ */
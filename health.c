@@ -0,0 +1,65 @@
+/*
+  health.c - continuous health tests on seed material
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <stdio.h>
+#include <string.h>
+#include "health.h"
+#include "exceptions.h"
+
+/* 1 + ceil(40/8): a run this long has probability 2^-40 at 8 bits/byte. */
+#define	RCT_CUTOFF	6
+
+/* Window size for non-binary sources and the matching 2^-40 cutoff. */
+#define	APT_WINDOW	512
+#define	APT_CUTOFF	19
+
+static void fail(struct health_st *h, const char *test)
+{
+	fprintf(stderr, "FATAL: seed material failed the %s test.\n", test);
+	memset(h, 0, sizeof(*h));
+	Throw(rng_health_exception);
+}
+
+void health_test(struct health_st *h, const unsigned char *buf, unsigned int n)
+{
+	unsigned int i;
+
+	for(i = 0; i < n; i++) {
+		if(h->rct_count && buf[i] == h->rct_value) {
+			if(++h->rct_count >= RCT_CUTOFF)
+				fail(h, "repetition count");
+		} else {
+			h->rct_value = buf[i];
+			h->rct_count = 1;
+		}
+
+		if(!h->apt_idx) {
+			h->apt_value = buf[i];
+			h->apt_count = 1;
+		} else if(buf[i] == h->apt_value && ++h->apt_count >= APT_CUTOFF) {
+			fail(h, "adaptive proportion");
+		}
+		if(++h->apt_idx == APT_WINDOW)
+			h->apt_idx = 0;
+	}
+}
@@ -0,0 +1,52 @@
+/*
+  health.h - continuous health tests on seed material
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef HEALTH_H__
+#define HEALTH_H__
+
+/**
+ * @file
+ * The repetition count and adaptive proportion tests of NIST SP 800-90B,
+ * section 4.4, run on every byte of seed material before it is used.
+ * The seed sources deliver conditioned output, so each byte is assessed at
+ * the full 8 bits of min-entropy; the cutoffs give a false alarm
+ * probability of 2^-40 per test.
+ */
+
+/** Test state; all zero before the first sample. */
+struct health_st {
+	unsigned int rct_count;		/* length of the current run */
+	unsigned int apt_count;		/* occurrences of apt_value in the window */
+	unsigned int apt_idx;		/* samples seen in the window */
+	unsigned char rct_value;
+	unsigned char apt_value;
+};
+
+/**
+ * Feed \e n bytes of seed material to the tests. If a test fails, a
+ * message is printed and rng_health_exception is thrown; the state is reset
+ * so that a retry starts from a clean slate.
+ */
+void health_test(struct health_st *h, const unsigned char *buf, unsigned int n);
+
+#endif	/* HEALTH_H__ */
@@ -24,17 +24,26 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <limits.h>
 #include <unistd.h>
 #include <math.h>
 #include "secure_memory.h"
 #include "secure_random.h"
 #include "pwgen.h"
+#include "encode.h"
+#include "base64.h"
+#include "outfile.h"
 #include "exceptions.h"
 
 static char rcsid[] = "$Id: main.c 1 2005-11-13 20:23:40Z zvrba $";
 
+/* Slots of the ring filled by the --prefill thread. */
+#define	PREFILL_SLOTS	4
+
 static struct exception_context exception_context;
-struct exception_context *the_exception_context = &exception_context;
+__thread struct exception_context *the_exception_context =
+	&exception_context;
 
 static void exit_cleanup(void)
 {
@@ -44,7 +53,14 @@ static void exit_cleanup(void)
 
 static void usage(const char *argv0)
 {
-	fprintf(stderr, "USAGE: %s <-p[e] | -A[adhsy] | -r | -s[e]> N\n", argv0);
+	const char *name;
+	unsigned int i;
+
+	fprintf(stderr, "USAGE: %s [--rng=NAME] [--hwrng=PATH] [--egd=PATH]\n"
+			"       [--prefill] [--deterministic-seed=FILE] [--output=FILE]\n"
+			"       [--direct] [--threads=N]\n"
+			"       <-p[e] | -A[adhsy] | -r[xbcz][un] | -R | -s[e]> N\n"
+			"       %s -K WORD\n", argv0, argv0);
 	fprintf(stderr,
 	    "\nPASSPHRASE of N words from Diceware dictionary\n"
 		"  -p    generate passphrase\n"
@@ -61,10 +77,89 @@ static void usage(const char *argv0)
 		"    y    3-4 letter syllables\n"
 		"\nRAW RANDOM\n"
 		"  -r    output BASE64 encoded string of N random BITS\n"
-		"  -k    output koremutake encoding of N random BITS\n");
+		"    x    encode in hexadecimal instead\n"
+		"    b    encode in base32 (RFC 4648) instead\n"
+		"    c    encode in Crockford's base32 instead\n"
+		"    z    encode in Z85 instead (N rounded up to 32 bits)\n"
+		"    u    use the URL and filename safe alphabet (base64url)\n"
+		"    n    leave out the trailing '=' padding (base64, base32)\n"
+		"  -k    output koremutake encoding of N random BITS\n"
+		"  -K    decode the koremutake WORD into the hex number it encodes\n"
+		"  -R    write N random BYTES unencoded to the --output FILE\n"
+		"\nOPTIONS\n"
+		"  --rng=NAME  use the named random number generator instead of the\n"
+		"              default (the first available one). Compiled in:\n"
+		"             ");
+	for(i = 0; (name = SRNG_backend_name(i)); i++)
+		fprintf(stderr, " %s", name);
+	fprintf(stderr, "\n"
+		"  --hwrng=PATH\n"
+		"              hardware random number device to seed from if the\n"
+		"              kernel's pool is not ready (default /dev/hwrng)\n"
+		"  --egd=PATH  seed from the entropy gathering daemon listening on\n"
+		"              the socket PATH if the kernel and device can't\n"
+		"  --prefill   generate random numbers ahead of demand in a background\n"
+		"              thread\n"
+		"  --deterministic-seed=FILE\n"
+		"              INSECURE, for testing only: seed from FILE so that\n"
+		"              every run gives the same output\n"
+		"  --output=FILE\n"
+		"              write the -r output to FILE (- for the standard\n"
+		"              output) as it is generated, so N is not limited\n"
+		"  --direct    write the -R output bypassing the page cache\n"
+		"              (O_DIRECT)\n"
+		"  --threads=N write the -R output with N threads, each filling its\n"
+		"              own part of the file from its own generator (1 to %u,\n"
+		"              default 1)\n", PWGEN_KEYFILE_MAX_THREADS);
 	exit(1);
 }
 
+/*
+ * Parse the letters after -r into the encoding.
+ * @return flags of encode(), or -1 on a bad letter or combination
+ */
+static int get_raw_encoding(const char *p, enum encoding *encoding)
+{
+	int flags = 0;
+
+	*encoding = encoding_base64;
+	for(; *p; p++) {
+		if(*p == 'u') {
+			flags |= base64_url;
+			continue;
+		}
+		if(*p == 'n') {
+			flags |= base64_nopad;
+			continue;
+		}
+		if(*encoding != encoding_base64)
+			return -1;
+		switch(*p) {
+		case 'x':
+			*encoding = encoding_hex;
+			break;
+		case 'b':
+			*encoding = encoding_base32;
+			break;
+		case 'c':
+			*encoding = encoding_crockford;
+			break;
+		case 'z':
+			*encoding = encoding_z85;
+			break;
+		default:
+			return -1;
+		}
+	}
+
+	if((flags & base64_url) && *encoding != encoding_base64)
+		return -1;
+	if((flags & base64_nopad) && *encoding != encoding_base64
+	&& *encoding != encoding_base32)
+		return -1;
+	return flags;
+}
+
 static unsigned int get_allowed_characters(const char *p)
 {
 	unsigned int characters = 0;
@@ -110,22 +205,121 @@ int main(int argc, char **argv)
 {
 	const char *getDiceWd(unsigned int);
 	const char *getSkeyWd(unsigned int);
+	unsigned long long number;
 	unsigned int n;
 	unsigned int srng_state_len;
+	unsigned long long length;
+	struct pwgen_output output;
+	const char *method;
+	const char *output_path = NULL;
+	int fd;
+	int argi;
+	int prefill = 0;
+	int direct = 0;
+	unsigned int threads = 1;
+	enum encoding encoding = encoding_base64;
+	int encoding_flags = 0;
 	float entropy;
 	enum exception_code exception;
 	int retval = 0;
 
 	init_exception_context(&exception_context);
 
-	if(argc != 3)
+	/* long options come before the method */
+	for(argi = 1; argi < argc && !strncmp(argv[argi], "--", 2); argi++) {
+		if(!strncmp(argv[argi], "--rng=", 6)) {
+			if(!SRNG_select(argv[argi]+6)) {
+				fprintf(stderr, "ERROR: unknown random number generator %s\n",
+						argv[argi]+6);
+				usage(argv[0]);
+			}
+		} else if(!strncmp(argv[argi], "--egd=", 6)) {
+			SRNG_egd(argv[argi]+6);
+		} else if(!strncmp(argv[argi], "--hwrng=", 8)) {
+			SRNG_hwrng(argv[argi]+8);
+		} else if(!strncmp(argv[argi], "--deterministic-seed=", 21)) {
+			if(!SRNG_deterministic_seed(argv[argi]+21))
+				usage(argv[0]);
+		} else if(!strncmp(argv[argi], "--output=", 9)) {
+			output_path = argv[argi]+9;
+		} else if(!strncmp(argv[argi], "--threads=", 10)) {
+			threads = atoi(argv[argi]+10);
+			if(threads < 1 || threads > PWGEN_KEYFILE_MAX_THREADS) {
+				fprintf(stderr, "ERROR: the number of threads must be "
+						"1 to %u\n", PWGEN_KEYFILE_MAX_THREADS);
+				usage(argv[0]);
+			}
+		} else if(!strcmp(argv[argi], "--direct")) {
+			direct = 1;
+		} else if(!strcmp(argv[argi], "--prefill")) {
+			prefill = 1;
+		} else {
+			usage(argv[0]);
+		}
+	}
+
+	if(argc - argi != 2)
 		usage(argv[0]);
+	method = argv[argi];
 
-	n = atoi(argv[2]);
-	if(n < 1) {
+	/* -K takes the word to decode instead of N */
+	if(!strcmp(method, "-K"))
+		number = 1;
+	else if(!isdigit((unsigned char)*argv[argi+1])
+	|| (number = strtoull(argv[argi+1], NULL, 10)) < 1) {
 		fprintf(stderr, "ERROR: N must be an integer > 0\n");
 		usage(argv[0]);
 	}
+	n = number > UINT_MAX ? UINT_MAX : number;
+
+	if((direct || threads > 1) && strcmp(method, "-R"))
+		usage(argv[0]);
+
+	if(!strcmp(method, "-R")) {
+		if(!output_path) {
+			fprintf(stderr, "ERROR: -R needs --output=FILE\n");
+			usage(argv[0]);
+		}
+		if(!strcmp(output_path, "-") && isatty(STDOUT_FILENO)) {
+			fprintf(stderr, "ERROR: not writing binary key material "
+					"to a terminal\n");
+			return 1;
+		}
+		if(threads > 1 && !strcmp(output_path, "-")) {
+			fprintf(stderr, "ERROR: --threads needs a regular file\n");
+			return 1;
+		}
+		length = pwgen_keyfile_buffer_size(threads) - 1;
+	} else if(output_path) {
+		/* only -r streams; the buffer holds one chunk, whatever N is */
+		if(strncmp(method, "-r", 2))
+			usage(argv[0]);
+		if((encoding_flags = get_raw_encoding(method+2, &encoding)) < 0)
+			usage(argv[0]);
+		length = PWGEN_STREAM_BUFFER_SIZE - 1;
+	} else if(number > UINT_MAX)
+		length = ULLONG_MAX;
+	else if(!strcmp(method, "-p") || !strcmp(method, "-pe"))
+		length = pwgen_diceware_length(n, getDiceWd, 8192);
+	else if(!strcmp(method, "-s") || !strcmp(method, "-se"))
+		length = pwgen_diceware_length(n, getSkeyWd, 2048);
+	else if(!strncmp(method, "-r", 2)) {
+		if((encoding_flags = get_raw_encoding(method+2, &encoding)) < 0)
+			usage(argv[0]);
+		length = pwgen_raw_length(n, encoding, encoding_flags);
+	} else if(!strcmp(method, "-k"))
+		length = pwgen_koremutake_length(n);
+	else if(!strcmp(method, "-K"))
+		length = pwgen_koremutake_decode_length(argv[argi+1]);
+	else if(!strncmp(method, "-A", 2))
+		length = pwgen_ascii_length(n);
+	else
+		usage(argv[0]);
+	if(length >= MAX_PASSPHRASE_SIZE) {
+		fprintf(stderr, "ERROR: N is too large, the output would be longer "
+				"than %u characters\n", MAX_PASSPHRASE_SIZE - 1);
+		return 1;
+	}
 
 	srng_state_len = SRNG_init(NULL);
 	if(srng_state_len > MAX_RANDOM_STATE_SIZE) {
@@ -134,10 +328,26 @@ int main(int argc, char **argv)
 				"(must be at least %u)\n", srng_state_len);
 		return 1;
 	}
+	if(SRNG_prefill(NULL, NULL, PREFILL_SLOTS) > MAX_RANDOM_RING_SIZE) {
+		fprintf(stderr, 
+				"FATAL: too small MAX_RANDOM_RING_SIZE "
+				"(must be at least %u)\n",
+				SRNG_prefill(NULL, NULL, PREFILL_SLOTS));
+		return 1;
+	}
 
 	Try {
-		secure_memory_init();
-		SRNG_init((struct SRNG_st*)G_secure_memory->random_state);
+		secure_memory_init(length + 1);
+		pwgen_output_init(&output, G_secure_memory->passphrase, length + 1);
+		/* decoding needs no random numbers */
+		if(strcmp(method, "-K")) {
+			SRNG_init((struct SRNG_st*)G_secure_memory->random_state);
+			fprintf(stderr, "INFO: seeded from %s.\n", SRNG_seed_source(
+						(struct SRNG_st*)G_secure_memory->random_state));
+			if(prefill)
+				SRNG_prefill((struct SRNG_st*)G_secure_memory->random_state,
+						G_secure_memory->random_ring, PREFILL_SLOTS);
+		}
 
 		if(atexit(exit_cleanup) < 0) {
 			fprintf(stderr, "FATAL: can't register cleanup handlers: \n");
@@ -145,45 +355,66 @@ int main(int argc, char **argv)
 			return 1;
 		}
 
-		if(!strcmp(argv[1], "-p"))
+		if(!strcmp(method, "-R")) {
+			fd = outfile_open(output_path, direct);
+			entropy = pwgen_keyfile(
+					(struct SRNG_st*)G_secure_memory->random_state, number,
+					threads, G_secure_memory->passphrase, fd);
+			outfile_close(fd);
+		} else if(output_path) {
+			fd = outfile_open(output_path, 0);
+			entropy = pwgen_raw_stream(
+					(struct SRNG_st*)G_secure_memory->random_state, number,
+					encoding, encoding_flags, G_secure_memory->passphrase,
+					fd);
+			outfile_close(fd);
+		} else if(!strcmp(method, "-p"))
 			entropy = pwgen_diceware(
 					(struct SRNG_st*)G_secure_memory->random_state, n, 0,
 					getDiceWd, 8192, G_secure_memory->random_numbers,
-					G_secure_memory->passphrase);
-		else if(!strcmp(argv[1], "-pe"))
+					&output);
+		else if(!strcmp(method, "-pe"))
 			entropy = pwgen_diceware(
 					(struct SRNG_st*)G_secure_memory->random_state, n, 1,
 					getDiceWd, 8192, G_secure_memory->random_numbers,
-					G_secure_memory->passphrase);
-		else if(!strcmp(argv[1], "-r"))
+					&output);
+		else if(!strncmp(method, "-r", 2))
 			entropy = pwgen_raw(
 					(struct SRNG_st*)G_secure_memory->random_state, n,
+					encoding, encoding_flags,
 					G_secure_memory->random_numbers,
-					G_secure_memory->passphrase);
-		else if(!strcmp(argv[1], "-k"))
+					&output);
+		else if(!strcmp(method, "-k"))
 			entropy = pwgen_koremutake(
 					(struct SRNG_st*)G_secure_memory->random_state, n,
 					G_secure_memory->random_numbers,
-					G_secure_memory->passphrase);
-		else if(!strcmp(argv[1], "-s"))
+					&output);
+		else if(!strcmp(method, "-K")) {
+			entropy = pwgen_koremutake_decode(argv[argi+1], &output);
+			if(entropy < 0) {
+				fprintf(stderr, "ERROR: %s is not a koremutake word\n",
+						argv[argi+1]);
+				retval = 1;
+			}
+		} else if(!strcmp(method, "-s"))
 			entropy = pwgen_diceware(
 					(struct SRNG_st*)G_secure_memory->random_state, n, 0,
 					getSkeyWd, 2048, G_secure_memory->random_numbers,
-					G_secure_memory->passphrase);
-		else if(!strcmp(argv[1], "-se"))
+					&output);
+		else if(!strcmp(method, "-se"))
 			entropy = pwgen_diceware(
 					(struct SRNG_st*)G_secure_memory->random_state, n, 1,
 					getSkeyWd, 2048, G_secure_memory->random_numbers,
-					G_secure_memory->passphrase);
-		else if(!strncmp(argv[1], "-A", 2)) {
-			unsigned int characters = get_allowed_characters(argv[1]+2);
+					&output);
+		else if(!strncmp(method, "-A", 2)) {
+			unsigned int characters = get_allowed_characters(method+2);
 
 			if(!characters)
 				usage(argv[0]);
 			entropy = pwgen_ascii(
 					(struct SRNG_st*)G_secure_memory->random_state, n,
 					characters, G_secure_memory->random_numbers,
-					G_secure_memory->passphrase);
+					&output);
 		} else {
 			usage(argv[0]);
 		}
@@ -197,6 +428,18 @@ int main(int argc, char **argv)
 			fprintf(stderr, "FATAL: crypto library error.\n");
 			retval = 1;
 			break;
+		case seed_exception:
+			fprintf(stderr, "FATAL: can't seed the random number generator.\n");
+			retval = 1;
+			break;
+		case rng_health_exception:
+			fprintf(stderr, "FATAL: random number generator failed.\n");
+			retval = 1;
+			break;
+		case output_overflow_exception:
+			fprintf(stderr, "FATAL: output buffer too small.\n");
+			retval = 1;
+			break;
 		case system_call_failed_exception:
 			fprintf(stderr, "FATAL: system call failed.\n");
 			retval = 1;
@@ -207,7 +450,10 @@ int main(int argc, char **argv)
 		}
 	}
 
-	if(!retval) {
+	if(!retval && output_path) {
+		fprintf(stderr, "INFO: wrote %s ;ENTROPY=%.2f bits\n",
+				strcmp(output_path, "-") ? output_path : "(stdout)", entropy);
+	} else if(!retval) {
 		printf("----------------\n");
 		/*
 		 * SECURITY NOTE
@@ -0,0 +1,216 @@
+/*
+  outfile.c - writing generated output to a file descriptor
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#define	_GNU_SOURCE		/* O_DIRECT */
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "outfile.h"
+#include "exceptions.h"
+
+#ifndef O_NOFOLLOW
+#define	O_NOFOLLOW	0
+#endif
+
+static const char *G_path = "(stdout)";
+static int G_direct;
+static int G_tail_fd = -1;	/* the same file without O_DIRECT */
+
+#ifdef O_DIRECT
+/* Open G_tail_fd on the file of fd, whose status is *st. */
+static void open_tail(int fd, const struct stat *st)
+{
+	struct stat tail_st;
+
+	if((G_tail_fd = open(G_path, O_WRONLY | O_NOFOLLOW)) < 0
+	|| fstat(G_tail_fd, &tail_st) < 0) {
+		perror(G_path);
+		goto error;
+	}
+	if(tail_st.st_dev != st->st_dev || tail_st.st_ino != st->st_ino) {
+		fprintf(stderr, "ERROR: %s was replaced while being opened.\n",
+				G_path);
+		goto error;
+	}
+	return;
+
+error:
+	if(G_tail_fd >= 0)
+		close(G_tail_fd);
+	G_tail_fd = -1;
+	close(fd);
+	Throw(system_call_failed_exception);
+}
+#endif
+
+int outfile_open(const char *path, int direct)
+{
+	int flags = O_WRONLY | O_CREAT | O_TRUNC | O_NOFOLLOW;
+	struct stat st;
+	int fd;
+
+	if(!strcmp(path, "-"))
+		return STDOUT_FILENO;
+
+	if(direct) {
+#ifdef O_DIRECT
+		flags |= O_DIRECT;
+		G_direct = 1;
+#else
+		fprintf(stderr, "WARNING: O_DIRECT is not supported, "
+				"writing through the page cache.\n");
+#endif
+	}
+
+	/*
+	 * The file holds secrets: nobody else may read it, not even briefly.
+	 * A symbolic link is refused rather than followed.
+	 */
+	while((fd = open(path, flags, 0600)) < 0) {
+#ifdef O_DIRECT
+		/* e.g. tmpfs refuses O_DIRECT */
+		if(errno == EINVAL && G_direct) {
+			fprintf(stderr, "WARNING: %s doesn't support O_DIRECT, "
+					"writing through the page cache.\n", path);
+			flags &= ~O_DIRECT;
+			G_direct = 0;
+			continue;
+		}
+#endif
+		perror(path);
+		Throw(system_call_failed_exception);
+	}
+
+	/*
+	 * The mode given to open() applies only to a new file; an existing
+	 * one keeps its own until it is changed here, before anything is
+	 * written. Devices such as /dev/null are left alone.
+	 */
+	if(fstat(fd, &st) < 0
+	|| (S_ISREG(st.st_mode) && fchmod(fd, 0600) < 0)) {
+		perror(path);
+		close(fd);
+		Throw(system_call_failed_exception);
+	}
+	G_path = path;
+
+#ifdef O_DIRECT
+	/*
+	 * O_DIRECT transfers whole blocks only, so the unaligned tail at the
+	 * end of the file goes through a second descriptor opened without it.
+	 * Clearing the flag on fd instead would affect every later write of
+	 * the threads that share it.
+	 */
+	if(G_direct)
+		open_tail(fd, &st);
+#endif
+	return fd;
+}
+
+/* A negative offset writes at the file position. */
+static void write_all(int fd, const char *p, size_t n, long long offset)
+{
+	ssize_t ret;
+
+	while(n) {
+		if(offset < 0)
+			ret = write(fd, p, n);
+		else
+			ret = pwrite(fd, p, n, offset);
+		if(ret < 0) {
+			if(errno == EINTR)
+				continue;
+			perror(G_path);
+			Throw(system_call_failed_exception);
+		}
+		p += ret; n -= ret;
+		if(offset >= 0)
+			offset += ret;
+	}
+}
+
+static void write_out(int fd, const void *buf, size_t n, long long offset)
+{
+	size_t aligned = n & ~(size_t)(OUTFILE_ALIGN - 1);
+	long long tail;
+
+	if(!G_direct || aligned == n) {
+		write_all(fd, buf, n, offset);
+		return;
+	}
+
+	/*
+	 * This is the end of the file: the tail goes through G_tail_fd, at
+	 * the offset where the aligned part ended.
+	 */
+	write_all(fd, buf, aligned, offset);
+	if(offset >= 0)
+		tail = offset + (long long)aligned;
+	else if((tail = lseek(fd, 0, SEEK_CUR)) < 0) {
+		perror(G_path);
+		Throw(system_call_failed_exception);
+	}
+	write_all(G_tail_fd, (const char*)buf + aligned, n - aligned, tail);
+}
+
+void outfile_write(int fd, const void *buf, size_t n)
+{
+	write_out(fd, buf, n, -1);
+}
+
+void outfile_pwrite(int fd, const void *buf, size_t n, unsigned long long offset)
+{
+	write_out(fd, buf, n, offset);
+}
+
+void outfile_close(int fd)
+{
+	struct stat st;
+	int failed = 0;
+
+	if(fd == STDOUT_FILENO)
+		return;
+
+	/* devices and pipes (e.g. /dev/null) can't be synced */
+	if(fstat(fd, &st) < 0) {
+		perror(G_path);
+		failed = 1;
+	} else if(S_ISREG(st.st_mode) && fsync(fd) < 0) {
+		perror(G_path);
+		failed = 1;
+	}
+	if(close(fd) < 0) {
+		perror(G_path);
+		failed = 1;
+	}
+	if(G_tail_fd >= 0 && close(G_tail_fd) < 0) {
+		perror(G_path);
+		failed = 1;
+	}
+	G_tail_fd = -1;
+	if(failed)
+		Throw(system_call_failed_exception);
+}
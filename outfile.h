@@ -0,0 +1,74 @@
+/*
+  outfile.h - writing generated output to a file descriptor
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef OUTFILE_H__
+#define OUTFILE_H__
+
+#include <stddef.h>
+
+/**
+ * @file
+ * Output of the streaming methods. The data goes straight from secure
+ * memory to the file descriptor with write(2), never through stdio
+ * buffers. Errors print a message and throw system_call_failed_exception.
+ */
+
+/** Alignment of buffers, lengths and offsets with O_DIRECT. */
+#define	OUTFILE_ALIGN	4096
+
+/**
+ * Open \e path for writing, creating it or truncating it, and give it mode
+ * 0600 before anything is written. A symbolic link is refused. "-" is the
+ * standard output.
+ *
+ * @param	direct	If non-0, bypass the page cache with O_DIRECT, where the
+ * 					system and file system support it (a warning is printed
+ * 					otherwise). Every write must then come from a buffer
+ * 					aligned to OUTFILE_ALIGN and, except the last one, be a
+ * 					multiple of OUTFILE_ALIGN long. The unaligned tail of
+ * 					the last one is written through a second descriptor
+ * 					without O_DIRECT; the flags of the returned one never
+ * 					change.
+ *
+ * @return	The file descriptor.
+ */
+int outfile_open(const char *path, int direct);
+
+/** Write all \e n bytes of \e buf to \e fd, retrying short writes. */
+void outfile_write(int fd, const void *buf, size_t n);
+
+/**
+ * Same as outfile_write(), but at \e offset in the file with pwrite(2), so
+ * several threads can write disjoint ranges of \e fd at once. With
+ * O_DIRECT, \e offset must be a multiple of OUTFILE_ALIGN.
+ */
+void outfile_pwrite(int fd, const void *buf, size_t n, unsigned long long offset);
+
+/**
+ * Close a descriptor returned by outfile_open(), flushing it to the disk
+ * with fsync(2) first if it is a regular file. The standard output is left
+ * alone.
+ */
+void outfile_close(int fd);
+
+#endif	/* OUTFILE_H__ */
@@ -23,9 +23,15 @@
 */
 #include <stdio.h>
 #include <string.h>
+#include <ctype.h>
 #include <math.h>
+#include <errno.h>
+#include <pthread.h>
 #include "secure_random.h"
 #include "pwgen.h"
+#include "encode.h"
+#include "outfile.h"
+#include "secure_memory.h"
 #include "exceptions.h"
 
 static char rcsid[] = "$Id: pwgen.c 1 2005-11-13 20:23:40Z zvrba $";
@@ -34,9 +40,9 @@ static char rcsid[] = "$Id: pwgen.c 1 2005-11-13 20:23:40Z zvrba $";
  * @file
  * This is intended to be the UI-independent part of password generation.
  *
- * @note	On the programming style in this code: I'm aware that strcat()
- * in a loop has quadratic performance, but here I just don't care and it
- * makes my life easier.
+ * All generators append to a struct pwgen_output, which keeps the length
+ * so that generation is linear in the output size, and throws
+ * output_overflow_exception instead of writing past the end of the buffer.
  */
 
 /******************************************************************************
@@ -120,10 +126,53 @@ static const char t_passphrase_enh[36] = {
 	'<', '>', '/', '?', '`', '~', '|', '\\', 'U', 'O', 'E', 'Y'
 };
 
+/******************************************************************************
+ * Output buffer.
+ *****************************************************************************/
+void pwgen_output_init(struct pwgen_output *output, char *buf, unsigned int size)
+{
+	output->buf = buf;
+	output->size = size;
+	output->len = 0;
+	*buf = 0;
+}
+
+/* Make room for n more characters and the terminating 0. */
+static char *output_reserve(struct pwgen_output *output, unsigned int n)
+{
+	if(n >= output->size - output->len) {
+		fprintf(stderr, "FATAL: output longer than %u characters.\n",
+				output->size - 1);
+		Throw(output_overflow_exception);
+	}
+	return output->buf + output->len;
+}
+
+static void output_append(
+		struct pwgen_output *output,
+		const char *s,
+		unsigned int n)
+{
+	memcpy(output_reserve(output, n), s, n);
+	output->len += n;
+	output->buf[output->len] = 0;
+}
+
+static void output_puts(struct pwgen_output *output, const char *s)
+{
+	output_append(output, s, strlen(s));
+}
+
 /******************************************************************************
  * Methods for password generation.
  *****************************************************************************/
 
+/*
+ * Words (or ASCII components) drawn per SRNG_uniform_n call; random_buffer
+ * holds 16 numbers.
+ */
+#define	WORD_BATCH	16
+
 float pwgen_diceware(
 		struct SRNG_st	*random_state,
 		unsigned int 	number_of_words,
@@ -131,108 +180,236 @@ float pwgen_diceware(
 		const char *	(*get_word)(unsigned int),
 		unsigned int 	dictionary_size,
 		unsigned int 	*random_buffer,
-		char 			*password_buffer)
+		struct pwgen_output *output)
 {
-	unsigned int i, word_length, output_index = 0;
+	unsigned int i, word_length, word_start;
 	const char *word;
 	float entropy = 0;
 
-	*password_buffer = 0;
 	for(i = 0; i < number_of_words; i++) {
-		SRNG_bytes(random_state, random_buffer, sizeof(*random_buffer));
-		word = get_word(*random_buffer);
+		if(!(i % WORD_BATCH))
+			SRNG_uniform_n(random_state, dictionary_size, random_buffer,
+					number_of_words - i < WORD_BATCH
+					? number_of_words - i : WORD_BATCH);
+		word = get_word(random_buffer[i % WORD_BATCH]);
 		word_length = strlen(word);
 
-		sprintf(password_buffer + output_index, "%s ", word);
+		word_start = output->len;
+		output_append(output, word, word_length);
+		output_append(output, " ", 1);
 		entropy += log(dictionary_size) / log(2);
 
 		if(is_enhanced) {
 			unsigned int char_pos, char_idx;
 
 			/* add a random symbol at random position into each word */
-			SRNG_bytes(random_state, random_buffer, 2*sizeof(*random_buffer));
-			char_pos = random_buffer[0] % word_length;
-			char_idx = random_buffer[1] % sizeof(t_passphrase_enh);
-			password_buffer[output_index+char_pos] =
-				t_passphrase_enh[char_idx];
+			char_pos = SRNG_uniform(random_state, word_length);
+			char_idx = SRNG_uniform(random_state, sizeof(t_passphrase_enh));
+			output->buf[word_start+char_pos] = t_passphrase_enh[char_idx];
 
 			/* 5.17 = log2(36) for each symbol plus the position randomness */
 			entropy += 5.17 + log(word_length) / log(2);
 		}
-		output_index += word_length+1;
 	}
 
 	return entropy;
 }
 
-//*********************************************************************
-//* Base64 - a simple base64 encoder and decoder.
-//*
-//*     Copyright (c) 1999, Bob Withers - bwit@pobox.com
-//*
-//* This code may be freely used for any purpose, either personal
-//* or commercial, provided the authors copyright notice remains
-//* intact.
-//*
-//* Converted to C in 2005 by Zeljko Vrba <zvrba@globalnet.hr>
-//*********************************************************************
-static void base64_encode(
-		const unsigned char *in,
-		unsigned int len,
-		char *out)
+unsigned long long pwgen_diceware_length(
+		unsigned int 	number_of_words,
+		const char *	(*get_word)(unsigned int),
+		unsigned int 	dictionary_size)
 {
-	static const char fillchar = '=';
-	static const char *cvt =
-		"ABCDEFGHIJKLMNOPQRSTUVWXYZ"
-		"abcdefghijklmnopqrstuvwxyz"
-		"0123456789+/";
-	unsigned int i;
-	unsigned char c;
+	unsigned int i, word_length, max_length = 0;
 
-	/*
-	 * SECURITY NOTE: single byte from the in string gets copied to the
-	 * local stack in each iteration of the loop.
-	 */
+	for(i = 0; i < dictionary_size; i++) {
+		word_length = strlen(get_word(i));
+		if(word_length > max_length)
+			max_length = word_length;
+	}
+	return (unsigned long long)number_of_words * (max_length + 1);
+}
 
-    for (i = 0; i < len; ++i) {
-		c = (in[i] >> 2) & 0x3f;
-		*out++ = cvt[c];
-		c = (in[i] << 4) & 0x3f;
-		if(++i < len)
-			c |= (in[i] >> 4) & 0x0f;
-		*out++ = cvt[c];
-		if(i < len) {
-			c = (in[i] << 2) & 0x3f;
-			if(++i < len)
-				c |= (in[i] >> 6) & 0x03;
-			*out++ = cvt[c];
-		} else {
-			++i;
-			*out++ = fillchar;
-		}
+/*
+ * Random bytes are drawn and encoded this many at a time; a multiple of 60,
+ * so that whole groups of every encoding fit and only the last chunk can
+ * need padding, and it fits random_buffer.
+ */
+#define	RAW_CHUNK	240
 
-		if(i < len) {
-			c = in[i] & 0x3f;
-			*out++ = cvt[c];
-		} else {
-			*out++ = fillchar;
-		}
-	}
-	*out++ = 0;
+/* Bits are rounded up to the bytes the encoding takes. */
+static unsigned long long raw_bytes(
+		unsigned long long number_of_bits,
+		enum encoding	encoding)
+{
+	return encode_input_length(encoding, ((number_of_bits-1)>>3)+1);
 }
 
 float pwgen_raw(
 		struct SRNG_st 	*random_state,
 		unsigned int 	number_of_bits,
+		enum encoding	encoding,
+		int				flags,
 		unsigned int 	*random_buffer,
-		char 			*password_buffer)
+		struct pwgen_output *output)
 {
-	unsigned int number_of_bytes = ((number_of_bits-1)>>3)+1;
+	unsigned int number_of_bytes = raw_bytes(number_of_bits, encoding);
+	unsigned int left, chunk;
+
+	for(left = number_of_bytes; left; left -= chunk) {
+		chunk = left < RAW_CHUNK ? left : RAW_CHUNK;
+		SRNG_bytes(random_state, random_buffer, chunk);
+		output->len += encode(encoding, (unsigned char*)random_buffer, chunk,
+				output_reserve(output, encode_length(encoding, chunk, flags)),
+				flags);
+	}
+	return number_of_bytes * 8.0f;
+}
+
+unsigned long long pwgen_raw_length(
+		unsigned int	number_of_bits,
+		enum encoding	encoding,
+		int				flags)
+{
+	return encode_length(encoding, raw_bytes(number_of_bits, encoding),
+			flags);
+}
 
-	SRNG_bytes(random_state, random_buffer, number_of_bytes);
-	base64_encode((unsigned char*)random_buffer, number_of_bytes,
-			password_buffer);
-	return number_of_bytes << 3;
+float pwgen_raw_stream(
+		struct SRNG_st 	*random_state,
+		unsigned long long number_of_bits,
+		enum encoding	encoding,
+		int				flags,
+		char			*buffer,
+		int				fd)
+{
+	unsigned long long number_of_bytes = raw_bytes(number_of_bits, encoding);
+	unsigned long long left;
+	unsigned int chunk, encoded;
+	char *text = buffer + PWGEN_STREAM_CHUNK;
+
+	for(left = number_of_bytes; left; left -= chunk) {
+		chunk = left < PWGEN_STREAM_CHUNK ? left : PWGEN_STREAM_CHUNK;
+		SRNG_bytes(random_state, buffer, chunk);
+		encoded = encode(encoding, (unsigned char*)buffer, chunk, text,
+				flags);
+		/* the newline fits in place of the terminating 0 */
+		if(chunk == left)
+			text[encoded++] = '\n';
+		outfile_write(fd, text, encoded);
+	}
+	return number_of_bytes * 8.0f;
+}
+
+/* Round up to a multiple of OUTFILE_ALIGN. */
+#define	ALIGN_UP(x)	(((x) + OUTFILE_ALIGN - 1) & ~(OUTFILE_ALIGN - 1UL))
+
+/* A thread of pwgen_keyfile() and the range [offset, end) it writes. */
+struct keyfile_worker {
+	struct SRNG_st		*random_state;	/* child of SRNG_split */
+	char				*buffer;
+	unsigned long long	offset;
+	unsigned long long	end;
+	int					fd;
+	pthread_t			thread;
+	enum exception_code	error;
+};
+
+static void *keyfile_thread(void *arg)
+{
+	struct keyfile_worker *w = arg;
+	struct exception_context ec;
+	enum exception_code e;
+	unsigned long long offset;
+	unsigned int chunk;
+
+	/* the caller's exception context is not valid in this thread */
+	the_exception_context = &ec;
+	init_exception_context(&ec);
+
+	Try {
+		for(offset = w->offset; offset < w->end; offset += chunk) {
+			chunk = w->end - offset < PWGEN_KEYFILE_CHUNK ?
+				w->end - offset : PWGEN_KEYFILE_CHUNK;
+			SRNG_bytes(w->random_state, w->buffer, chunk);
+			outfile_pwrite(w->fd, w->buffer, chunk, offset);
+		}
+	} Catch(e) {
+		w->error = e;
+	}
+	return NULL;
+}
+
+unsigned int pwgen_keyfile_buffer_size(unsigned int number_of_threads)
+{
+	if(number_of_threads == 1)
+		return PWGEN_KEYFILE_CHUNK + OUTFILE_ALIGN;
+	return number_of_threads * (PWGEN_KEYFILE_CHUNK
+			+ ALIGN_UP(SRNG_split(NULL, NULL, 0))) + OUTFILE_ALIGN;
+}
+
+float pwgen_keyfile(
+		struct SRNG_st 	*random_state,
+		unsigned long long number_of_bytes,
+		unsigned int	number_of_threads,
+		char			*buffer,
+		int				fd)
+{
+	struct keyfile_worker workers[PWGEN_KEYFILE_MAX_THREADS];
+	unsigned long long left, range;
+	unsigned int chunk, state_size, i, started;
+	int err;
+
+	buffer += -(unsigned long)buffer & (OUTFILE_ALIGN - 1);
+	if(number_of_threads == 1) {
+		for(left = number_of_bytes; left; left -= chunk) {
+			chunk = left < PWGEN_KEYFILE_CHUNK ? left : PWGEN_KEYFILE_CHUNK;
+			SRNG_bytes(random_state, buffer, chunk);
+			outfile_write(fd, buffer, chunk);
+		}
+		return number_of_bytes * 8.0f;
+	}
+
+	/*
+	 * Each thread gets a contiguous range of whole chunks, so all offsets
+	 * are aligned for O_DIRECT, a substream of its own and a buffer for
+	 * one chunk followed by the substream's state.
+	 */
+	range = (number_of_bytes + PWGEN_KEYFILE_CHUNK - 1) / PWGEN_KEYFILE_CHUNK;
+	range = (range + number_of_threads - 1) / number_of_threads
+		* PWGEN_KEYFILE_CHUNK;
+	state_size = ALIGN_UP(SRNG_split(NULL, NULL, 0));
+	memset(workers, 0, sizeof(workers));
+	for(i = 0; i < number_of_threads && i * range < number_of_bytes; i++) {
+		workers[i].buffer = buffer + i * (PWGEN_KEYFILE_CHUNK + state_size);
+		workers[i].random_state =
+			(struct SRNG_st*)(workers[i].buffer + PWGEN_KEYFILE_CHUNK);
+		workers[i].offset = i * range;
+		workers[i].end = number_of_bytes - workers[i].offset < range ?
+			number_of_bytes : workers[i].offset + range;
+		workers[i].fd = fd;
+		SRNG_split(random_state, workers[i].random_state, i);
+	}
+	number_of_threads = i;
+
+	for(started = 0, err = 0; started < number_of_threads; started++)
+		if((err = secure_thread_create(&workers[started].thread,
+						keyfile_thread, &workers[started])))
+			break;
+	for(i = 0; i < started; i++)
+		pthread_join(workers[i].thread, NULL);
+	for(i = 0; i < number_of_threads; i++)
+		SRNG_destroy(workers[i].random_state);
+
+	if(err) {
+		errno = err;
+		perror("pthread_create");
+		Throw(system_call_failed_exception);
+	}
+	for(i = 0; i < number_of_threads; i++)
+		if(workers[i].error)
+			Throw(workers[i].error);
+	return number_of_bytes * 8.0f;
 }
 
 /*
@@ -243,27 +420,166 @@ float pwgen_koremutake(
 		struct SRNG_st 	*random_state,
 		unsigned int 	number_of_bits,
 		unsigned int 	*random_buffer,
-		char 			*password_buffer)
+		struct pwgen_output *output)
 {
-	unsigned int i, number_of_bytes = ((number_of_bits-1)/7)+1;
-	unsigned char *u8buf = (unsigned char*)random_buffer;
-
-	SRNG_bytes(random_state, random_buffer, number_of_bytes);
-	*password_buffer = 0;
-	for(i = 0; i < number_of_bytes; i++)
-		strcat(password_buffer, koremutake_syllables[u8buf[i] & 127]);
-	return number_of_bytes * 7;
+	unsigned int i, number_of_syllables = ((number_of_bits-1)/7)+1;
+
+	for(i = 0; i < number_of_syllables; i++) {
+		*random_buffer = SRNG_bits(random_state, 7);
+		output_puts(output, koremutake_syllables[*random_buffer]);
+	}
+	return number_of_syllables * 7;
 }
 
-static void select_class(
-		struct SRNG_st	*random_state,
-		unsigned int	allowed_classes,
-		unsigned int	*random_buffer)
+unsigned long long pwgen_koremutake_length(unsigned int number_of_bits)
+{
+	/* the longest syllables have 3 letters */
+	return (((number_of_bits-1)/7)+1) * 3ULL;
+}
+
+/*
+ * Every syllable is one or two consonants followed by a vowel, so a word
+ * splits into syllables at its vowels. Each syllable hashes without
+ * collisions to [first letter][second consonant or 0][vowel], and the
+ * table holds its index + 1 (0 for letter combinations that are not
+ * syllables). It is filled from koremutake_syllables on first use.
+ */
+static const char koremutake_vowels[] = "AEIOUY";
+static unsigned char koremutake_index[26][27][6];
+static pthread_once_t koremutake_index_once = PTHREAD_ONCE_INIT;
+
+static int koremutake_vowel(char c)
+{
+	const char *v = strchr(koremutake_vowels, c);
+
+	return c && v ? v - koremutake_vowels : -1;
+}
+
+static void koremutake_index_init(void)
+{
+	const char *s;
+	unsigned int i, n;
+
+	for(i = 0; i < 128; i++) {
+		s = koremutake_syllables[i];
+		n = strlen(s);
+		koremutake_index[s[0] - 'A'][n == 3 ? s[1] - 'A' + 1 : 0]
+			[koremutake_vowel(s[n-1])] = i + 1;
+	}
+}
+
+/*
+ * Parse the syllable at *p and advance *p past it.
+ * @return	its 7-bit value, or -1 if there is no valid syllable at *p.
+ */
+static int koremutake_parse(const char **p)
+{
+	char c[3];
+	int i, v;
+
+	for(i = 0; i < 3; i++) {
+		c[i] = toupper((unsigned char)(*p)[i]);
+		if(c[i] < 'A' || c[i] > 'Z')
+			return -1;
+		if((v = koremutake_vowel(c[i])) >= 0)
+			break;
+	}
+	if(i == 0 || i == 3)
+		return -1;
+
+	*p += i + 1;
+	return koremutake_index[c[0] - 'A'][i == 2 ? c[1] - 'A' + 1 : 0][v] - 1;
+}
+
+float pwgen_koremutake_decode(
+		const char		*word,
+		struct pwgen_output *output)
+{
+	const char *p;
+	unsigned int number_of_syllables, bits;
+	unsigned long acc;
+	char *out;
+	int v;
+
+	pthread_once(&koremutake_index_once, koremutake_index_init);
+
+	for(p = word, number_of_syllables = 0; *p; number_of_syllables++)
+		if(koremutake_parse(&p) < 0)
+			return -1;
+	if(!number_of_syllables)
+		return -1;
+
+	/*
+	 * Syllables are base-128 digits, the first one the most significant.
+	 * Zero bits in front align the number to whole hex digits, which are
+	 * then taken from the top of the accumulator 4 bits at a time.
+	 */
+	out = output_reserve(output, (7 * number_of_syllables + 3) / 4);
+	bits = (4 - 7 * number_of_syllables % 4) % 4;
+	for(p = word, acc = 0; *p; ) {
+		v = koremutake_parse(&p);
+		acc = acc << 7 | v;
+		for(bits += 7; bits >= 4; bits -= 4)
+			*out++ = "0123456789abcdef"[(acc >> (bits - 4)) & 15];
+	}
+	*out = 0;
+	output->len = out - output->buf;
+	return number_of_syllables * 7;
+}
+
+unsigned long long pwgen_koremutake_decode_length(const char *word)
 {
-	do {
-		SRNG_bytes(random_state, random_buffer, sizeof(*random_buffer));
-		*random_buffer %= N_CHARACTER_CLASSES;	/* not a LCG, so % is OK */
-	} while(!(allowed_classes & character_classes[*random_buffer].chr));
+	/* the shortest syllables have 2 letters */
+	return (7 * (strlen(word) / 2) + 3) / 4;
+}
+
+/*
+ * The old method chose an allowed class uniformly, threw two dice for a
+ * slot of its 36-entry table (and a third for the vowel of a syllable),
+ * and started over on an empty slot. That is a uniform choice among all
+ * non-empty (class, slot[, vowel]) combinations, so here they are laid
+ * out in one alphabet and a component takes a single uniform draw: each
+ * slot of a class without the third die appears once for every face of
+ * that die, each combination of a class with it once.
+ */
+#define	DICE3_FACES		6
+#define	MAX_ALPHABET	(N_CHARACTER_CLASSES * 36 * DICE3_FACES)
+
+struct ascii_alphabet {
+	unsigned int	size;
+	struct {
+		char			s[4];		/* the component */
+		unsigned char	class;		/* index into character_classes */
+	} entry[MAX_ALPHABET];
+};
+
+static void ascii_alphabet_init(
+		struct ascii_alphabet	*alphabet,
+		unsigned int			allowed_classes)
+{
+	unsigned int c, i, j, n, copies = 1;
+
+	if(allowed_classes & chr_syllables)
+		copies = DICE3_FACES;
+
+	alphabet->size = 0;
+	for(c = 0; c < N_CHARACTER_CLASSES; c++) {
+		if(!(allowed_classes & character_classes[c].chr))
+			continue;
+		for(i = 0; i < 36; i++) {
+			if(!character_classes[c].dice12[i])
+				continue;
+			n = character_classes[c].dice3 ? DICE3_FACES : copies;
+			for(j = 0; j < n; j++) {
+				strcpy(alphabet->entry[alphabet->size].s,
+						character_classes[c].dice12[i]);
+				if(character_classes[c].dice3)
+					strcat(alphabet->entry[alphabet->size].s,
+							character_classes[c].dice3[j]);
+				alphabet->entry[alphabet->size++].class = c;
+			}
+		}
+	}
 }
 
 float pwgen_ascii(
@@ -271,42 +587,28 @@ float pwgen_ascii(
 		unsigned int 	number_of_components,
 		unsigned int 	allowed_classes,
 		unsigned int 	*random_buffer,
-		char 			*password_buffer)
+		struct pwgen_output *output)
 {
-	unsigned int i;
-	unsigned int *character_class = random_buffer;
-	unsigned int *dice12 = character_class + 1;
-	unsigned int *dice3  = character_class + 2;
+	struct ascii_alphabet alphabet;
+	unsigned int i, k;
 	float entropy = 0;
 
-	password_buffer[0] = 0;
+	ascii_alphabet_init(&alphabet, allowed_classes);
 	for(i = 0; i < number_of_components; i++) {
-retry:
-		/* select character class and throw 3 dice */
-		select_class(random_state, allowed_classes, character_class);
-		SRNG_bytes(random_state, dice12, 2);
-		*dice12 %= 36;	/* 1st and 2nd dice */
-		*dice3  %= 6;	/* 3rd dice */
-
-		if(character_classes[*character_class].dice12[*dice12]) {
-			strcat(password_buffer,
-					character_classes[*character_class].dice12[*dice12]);
-			if(!character_classes[*character_class].dice3)
-				entropy += character_classes[*character_class].entropy;
-		} else {
-			goto retry;
-		}
-
-		if(character_classes[*character_class].dice3) {
-			if(character_classes[*character_class].dice3[*dice3]) {
-				strcat(password_buffer,
-						character_classes[*character_class].dice3[*dice3]);
-				entropy += character_classes[*character_class].entropy;
-			} else {
-				goto retry;
-			}
-		}
+		if(!(i % WORD_BATCH))
+			SRNG_uniform_n(random_state, alphabet.size, random_buffer,
+					number_of_components - i < WORD_BATCH
+					? number_of_components - i : WORD_BATCH);
+		k = random_buffer[i % WORD_BATCH];
+		output_puts(output, alphabet.entry[k].s);
+		entropy += character_classes[alphabet.entry[k].class].entropy;
 	}
 
 	return entropy;
 }
+
+unsigned long long pwgen_ascii_length(unsigned int number_of_components)
+{
+	/* the longest component is a 2-letter syllable start and a vowel */
+	return number_of_components * 3ULL;
+}
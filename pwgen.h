@@ -24,12 +24,29 @@
 #ifndef PWGEN_H__
 #define PWGEN_H__
 
+#include "outfile.h"
+#include "encode.h"
+
 /**
  * @file
  * This defines the interface to platform-independent secure password
  * generation routines.
  */
 
+/**
+ * A bounded output buffer that the generators append to. Appending is
+ * O(length of the appended string); appending past the end prints a message
+ * and throws output_overflow_exception.
+ */
+struct pwgen_output {
+	char			*buf;
+	unsigned int	size;	/* capacity, including the terminating 0 */
+	unsigned int	len;	/* characters written so far */
+};
+
+/** Set up \e output to write into \e buf of \e size bytes (at least 1). */
+void pwgen_output_init(struct pwgen_output *output, char *buf, unsigned int size);
+
 /**
  * Generate passphrase by the 'diceware' method: a number of words selected
  * from a fixed list.
@@ -40,12 +57,12 @@
  * @param	get_word		Pointer to the 'get word' function.
  * @param	dictionary_size	Number of words in the dictionary.
  * @param	random_buffer	Buffer into which to generate random numbers.
- * @param	password_buffer	Buffer to output passphrase to.
+ * @param	output			Output buffer the passphrase is appended to.
  *
- * @note	rndbuf and pwbuf are provided so that all sensitive output can
- * 			be put into the secure memory, if available. There are no sizes
- * 			specified, but generally rndbuf should have at least 64 bytes,
- * 			and pwbuf at least 512 bytes.
+ * @note	random_buffer and output are provided so that all sensitive
+ * 			output can be put into the secure memory, if available.
+ * 			The output buffer needs pwgen_diceware_length() characters
+ * 			plus the terminating 0.
  *
  * @return	Estimated password entropy.
  */
@@ -56,26 +73,114 @@ float pwgen_diceware(
 		const char *	(*get_word)(unsigned int),
 		unsigned int 	dictionary_size,
 		unsigned int 	*random_buffer,
-		char 			*password_buffer);
+		struct pwgen_output *output);
 
 /**
- * Generate a raw random passphrase of n bits encoded into base64.
+ * @return	Upper bound on the length of a pwgen_diceware() passphrase,
+ * 			without the terminating 0.
+ */
+unsigned long long pwgen_diceware_length(
+		unsigned int 	number_of_words,
+		const char *	(*get_word)(unsigned int),
+		unsigned int 	dictionary_size);
+
+/**
+ * Generate a raw random passphrase of n bits in a text encoding. The bits
+ * are rounded up to whole bytes, and for Z85 to groups of 4 bytes; the
+ * entropy is that of the bytes encoded.
  *
  * @param	random_state	Random state.
  * @param	number_of_bits	Number of bits.
- * @param	random_buffer	Buffer into which to generate random numbers.
- * @param	password_buffer	Buffer to output passphrase to.
- *
- * @todo	Use our own base64 encoder so we don't have to use mlockall()
- * 			and OpenSSL.
+ * @param	encoding		Encoding, see encode.h.
+ * @param	flags			Alphabet and padding, see encode_length().
+ * @param	random_buffer	Buffer into which to generate random numbers,
+ * 							at least 240 bytes.
+ * @param	output			Output buffer the passphrase is appended to.
  *
  * @return	Estimated password entropy.
  */
 float pwgen_raw(
 		struct SRNG_st *random_state,
 		unsigned int number_of_bits,
+		enum encoding encoding,
+		int flags,
 		unsigned int *random_buffer,
-		char *password_buffer);
+		struct pwgen_output *output);
+
+/** @return	Length of a pwgen_raw() passphrase. */
+unsigned long long pwgen_raw_length(
+		unsigned int number_of_bits,
+		enum encoding encoding,
+		int flags);
+
+/**
+ * Random bytes drawn per chunk by pwgen_raw_stream(); a multiple of 60, so
+ * that only the last chunk can need padding in any encoding.
+ */
+#define	PWGEN_STREAM_CHUNK			(60U << 10)
+
+/**
+ * Size of the buffer needed by pwgen_raw_stream(): hex, the longest
+ * encoding, doubles the chunk.
+ */
+#define	PWGEN_STREAM_BUFFER_SIZE	(3 * PWGEN_STREAM_CHUNK + 1)
+
+/**
+ * Same as pwgen_raw(), but the output is written to \e fd chunk by chunk,
+ * followed by a newline, so its length is not limited by the memory.
+ *
+ * @param	random_state	Random state.
+ * @param	number_of_bits	Number of bits.
+ * @param	encoding		Encoding, see encode.h.
+ * @param	flags			Alphabet and padding, see encode_length().
+ * @param	buffer			Buffer of PWGEN_STREAM_BUFFER_SIZE bytes for one
+ * 							chunk of random bytes and its encoding.
+ * @param	fd				File descriptor to write to, see outfile.h.
+ *
+ * @return	Estimated password entropy.
+ */
+float pwgen_raw_stream(
+		struct SRNG_st *random_state,
+		unsigned long long number_of_bits,
+		enum encoding encoding,
+		int flags,
+		char *buffer,
+		int fd);
+
+/** Random bytes written per chunk by pwgen_keyfile(). */
+#define	PWGEN_KEYFILE_CHUNK			(1U << 20)
+
+/** Maximum number of threads of pwgen_keyfile(). */
+#define	PWGEN_KEYFILE_MAX_THREADS	32
+
+/** @return	Size of the buffer needed by pwgen_keyfile(). */
+unsigned int pwgen_keyfile_buffer_size(unsigned int number_of_threads);
+
+/**
+ * Write \e n random bytes, unencoded, to \e fd, e.g. for a LUKS keyfile.
+ * They are generated and written in chunks of PWGEN_KEYFILE_CHUNK bytes
+ * from parts of \e buffer aligned to OUTFILE_ALIGN, so \e fd may be
+ * opened with O_DIRECT.
+ *
+ * With more than one thread, the file is split into as many contiguous
+ * ranges. Each thread fills its range from a child of \e random_state
+ * (see SRNG_split) with pwrite(2), so \e fd must be a regular file.
+ *
+ * @param	random_state		Random state.
+ * @param	number_of_bytes		Number of bytes.
+ * @param	number_of_threads	1 to PWGEN_KEYFILE_MAX_THREADS.
+ * @param	buffer				Buffer of pwgen_keyfile_buffer_size() bytes
+ * 								for the chunks and the children's states.
+ * @param	fd					File descriptor to write to, see outfile.h.
+ *
+ * @return	Estimated entropy.
+ */
+float pwgen_keyfile(
+		struct SRNG_st *random_state,
+		unsigned long long number_of_bytes,
+		unsigned int number_of_threads,
+		char *buffer,
+		int fd);
 
 /**
  * Generate a raw random passphrase of n bits encoded by koremutake encoding
@@ -84,10 +189,7 @@ float pwgen_raw(
  * @param	random_state	Random state.
  * @param	number_of_bits	Number of bits.
  * @param	random_buffer	Buffer into which to generate random numbers.
- * @param	password_buffer	Buffer to output passphrase to.
- *
- * @todo	Use our own base64 encoder so we don't have to use mlockall()
- * 			and OpenSSL.
+ * @param	output			Output buffer the passphrase is appended to.
  *
  * @return	Estimated password entropy.
  */
@@ -95,7 +197,29 @@ float pwgen_koremutake(
 		struct SRNG_st *random_state,
 		unsigned int number_of_bits,
 		unsigned int *random_buffer,
-		char *password_buffer);
+		struct pwgen_output *output);
+
+/** @return	Upper bound on the length of a pwgen_koremutake() passphrase. */
+unsigned long long pwgen_koremutake_length(unsigned int number_of_bits);
+
+/**
+ * Decode a word made by pwgen_koremutake() (in upper or lower case) back
+ * into the number whose base-128 digits are its syllables, and append
+ * that to \e output in hexadecimal, without leading zero bits beyond the
+ * next multiple of 4 bits.
+ *
+ * @return	Number of bits in the word (7 per syllable), or -1 if it is
+ * 			not a koremutake word.
+ */
+float pwgen_koremutake_decode(
+		const char *word,
+		struct pwgen_output *output);
+
+/**
+ * @return	Upper bound on the length of the pwgen_koremutake_decode()
+ * 			output.
+ */
+unsigned long long pwgen_koremutake_decode_length(const char *word);
 
 /** Allowable character classes for pwgen_ascii. */
 enum character_classes {
@@ -114,7 +238,8 @@ enum character_classes {
  * @param	character_classes		Bit-set of allowed character classes.
  * @param	random_buffer			Buffer into which to generate random
  * 									numbers.
- * @param	password_buffer			Buffer to output passphrase to.
+ * @param	output					Output buffer the passphrase is appended
+ * 									to.
  *
  * @see		character_classes.
  *
@@ -125,6 +250,9 @@ float pwgen_ascii(
 		unsigned int number_of_components,
 		unsigned int character_classes,
 		unsigned int *random_buffer,
-		char *password_buffer);
+		struct pwgen_output *output);
+
+/** @return	Upper bound on the length of a pwgen_ascii() passphrase. */
+unsigned long long pwgen_ascii_length(unsigned int number_of_components);
 
 #endif	/* PWGEN_H__ */
@@ -24,32 +24,61 @@
 #ifndef SECURE_MEMORY_H__
 #define SECURE_MEMORY_H__
 
+#include <pthread.h>
+
 /**
  * @file
  * This defines the contents of the secure memory.
  */
 
 /** Maximum size of random state. */
-#define	MAX_RANDOM_STATE_SIZE	8192
+#define	MAX_RANDOM_STATE_SIZE	16384
+
+/** Maximum size of the prefill ring (see SRNG_prefill). */
+#define	MAX_RANDOM_RING_SIZE	20480
+
+/**
+ * Stack size of the threads started by secure_thread_create(). Under
+ * mlockall(MCL_FUTURE) every thread stack is locked, and the default of
+ * 8 MiB alone would exceed the usual RLIMIT_MEMLOCK of unprivileged users.
+ */
+#define	SECURE_THREAD_STACK_SIZE	(64U << 10)
+
+/** Maximum size of the passphrase, including the terminating 0. */
+#define	MAX_PASSPHRASE_SIZE		(64U << 20)
 
 struct secure_memory {
 	unsigned char random_state[MAX_RANDOM_STATE_SIZE];
+	unsigned char random_ring[MAX_RANDOM_RING_SIZE];
 	unsigned int  random_numbers[64];
-	char          passphrase[1];
+	char          passphrase[1];	/* secure_memory_init() sizes it */
 };
 
 extern struct secure_memory *G_secure_memory;
 extern unsigned int G_secure_memory_size;
 
 /**
- * Set up a chunk of secure memory.
+ * Set up a chunk of secure memory with room for a passphrase of
+ * \e passphrase_size bytes (including the terminating 0).
  *
  * @return	0 if at least one operation failed, 1 otherwise. In either case
  * the program execution can continue. There may be other side-effects such
  * as printing warnings. If there was a fatal error, this function will
  * terminate the program.
  */
-int secure_memory_init(void);
+int secure_memory_init(unsigned int passphrase_size);
+
+/**
+ * Start a thread like pthread_create(), with a stack of
+ * SECURE_THREAD_STACK_SIZE bytes. Thread functions must not keep large
+ * buffers on the stack.
+ *
+ * @return	0 on success, an error number otherwise.
+ */
+int secure_thread_create(
+	pthread_t *thread,
+	void *(*start)(void*),
+	void *arg);
 
 /** Destroy secure memory. Zeroes it before destruction. */
 void secure_memory_destroy(void);
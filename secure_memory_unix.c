@@ -24,6 +24,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stddef.h>
+#include <limits.h>
 #include <math.h>
 #include <sys/types.h>
 #include <sys/time.h>
@@ -44,16 +46,22 @@ struct secure_memory *G_secure_memory;
 unsigned int G_secure_memory_size;
 static long G_pagesize;
 
-static int allocate_secure_memory(void)
+static int allocate_secure_memory(unsigned int passphrase_size)
 {
 	int retval = 1;
+#ifdef MADV_WIPEONFORK
+	size_t wipe_size;
+#endif
 
 	if((G_pagesize = sysconf(_SC_PAGESIZE)) < 0) {
 		perror("sysconf");
 		Throw(system_call_failed_exception);
 	}
 
-	G_secure_memory_size = 16*G_pagesize;
+	/* the passphrase is followed by a guard page */
+	G_secure_memory_size = (offsetof(struct secure_memory, passphrase)
+			+ passphrase_size + G_pagesize - 1) & ~(G_pagesize - 1);
+	G_secure_memory_size += G_pagesize;
 	G_secure_memory = mmap(NULL, G_secure_memory_size, PROT_READ | PROT_WRITE,
 			MAP_ANON | MAP_PRIVATE, -1, 0);
 	if(G_secure_memory == MAP_FAILED) {
@@ -61,8 +69,21 @@ static int allocate_secure_memory(void)
 		Throw(out_of_memory_exception);
 	}
 
+#ifdef MADV_WIPEONFORK
+	/*
+	 * A child of fork() gets the random state zeroed (whole pages only),
+	 * which SRNG notices and reseeds. On kernels before 4.14 this fails
+	 * and SRNG relies on its pthread_atfork() handler alone.
+	 */
+	wipe_size = offsetof(struct secure_memory, random_numbers)
+		& ~(G_pagesize - 1);
+	if(wipe_size)
+		madvise(G_secure_memory, wipe_size, MADV_WIPEONFORK);
+#endif
+
 	/* This is to guarantee segfault on buffer overrun. */
-	if(mprotect((char*)G_secure_memory + 15*G_pagesize, G_pagesize,
+	if(mprotect((char*)G_secure_memory +
+				G_secure_memory_size - G_pagesize, G_pagesize,
 				PROT_NONE) < 0) {
 		perror("mprotect");
 		Throw(system_call_failed_exception);
@@ -113,11 +134,11 @@ static int disable_core_file(void)
 	return retval;
 }
 
-int secure_memory_init(void)
+int secure_memory_init(unsigned int passphrase_size)
 {
 	int success;
 
-	success  = allocate_secure_memory();
+	success  = allocate_secure_memory(passphrase_size);
 	drop_privileges();
 	success &= disable_core_file();
 
@@ -127,8 +148,29 @@ int secure_memory_init(void)
 	return success;
 }
 
+int secure_thread_create(
+	pthread_t *thread,
+	void *(*start)(void*),
+	void *arg)
+{
+	pthread_attr_t attr;
+	size_t stack_size = SECURE_THREAD_STACK_SIZE;
+	int err;
+
+#ifdef PTHREAD_STACK_MIN
+	if(stack_size < PTHREAD_STACK_MIN)
+		stack_size = PTHREAD_STACK_MIN;
+#endif
+	if((err = pthread_attr_init(&attr)))
+		return err;
+	if(!(err = pthread_attr_setstacksize(&attr, stack_size)))
+		err = pthread_create(thread, &attr, start, arg);
+	pthread_attr_destroy(&attr);
+	return err;
+}
+
 void secure_memory_destroy(void)
 {
-	printf("INFO: zeroing memory.\n");
+	fprintf(stderr, "INFO: zeroing memory.\n");
 	memset(G_secure_memory, 0, G_secure_memory_size - G_pagesize);
 }
@@ -0,0 +1,778 @@
+/*
+  secure_random.c - run-time selection of the secure random number generator
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <pthread.h>
+#include "secure_random.h"
+#include "secure_random_backend.h"
+#include "chacha20.h"
+#include "health.h"
+#include "cpu_random.h"
+#include "seed.h"
+#include "secure_memory.h"
+#include "exceptions.h"
+
+/**
+	@file
+	Dispatches the SRNG interface to one of the compiled-in backends.
+	Which backends are compiled in is decided by the WITH_* macros set in
+	the Makefile.
+
+	Small requests are served from a pool of POOL_SIZE bytes that is
+	refilled from the backend in one call, so the cipher always runs on
+	large batches and a request of a few bytes costs a memcpy. The pool
+	is part of struct SRNG_st and thus in locked memory; every byte is
+	zeroed as soon as it is handed out.
+
+	Children created by SRNG_split() use the internal "substream" backend,
+	a ChaCha20 generator keyed by the parent.
+
+	With SRNG_deterministic_seed() every seed is instead the next ChaCha20
+	block under the key from the seed file, counted per state, and there
+	is no mixing and no time-based reseeding, so a state produces the same
+	stream on every run.
+
+	Seed material is read into the state from the first source of the
+	chain in seed.c that delivers in time, or from the backend's own source
+	if none does. It is checked by the health tests, XORed with
+	RDSEED/RDRAND output where the CPU has it and handed to the backend.
+	The backend is reseeded when it has produced
+	reseed_bytes bytes or is reseed_seconds old, whichever comes first;
+	this is checked only when the backend is called, i.e. once per pool
+	refill, so it costs nothing per request.
+
+	A state copied by fork() is detected on its next use by comparing a
+	fork generation, bumped in the child by a pthread_atfork() handler, and
+	then reseeded (see after_fork). In secure memory the state is also
+	marked MADV_WIPEONFORK, so a child never even sees the parent's buffered
+	output.
+
+	After SRNG_prefill() the backend is driven by a producer thread that
+	fills a ring of POOL_SIZE slots. The pool then points into the ring
+	and a refill only moves on to the next slot. Producer and consumer
+	synchronize through the head and tail counters alone; the mutex and
+	condition variables are touched only when one of them has to sleep,
+	i.e. when the ring is full or empty.
+*/
+
+/*
+ * Compiled-in backends, in order of preference for the default: the
+ * kernel's vDSO generator needs no user-space cipher at all, ChaCha20 is
+ * the fastest software generator on any CPU, then AES (fast only with
+ * AES-NI), Blowfish and cryptlib.
+ */
+static const struct SRNG_backend *backends[] = {
+#ifdef WITH_GETRANDOM
+	&SRNG_backend_vgetrandom,
+#endif
+#ifdef WITH_OPENSSL
+	&SRNG_backend_chacha20,
+#endif
+#ifdef WITH_GETRANDOM
+	&SRNG_backend_getrandom,
+#endif
+#ifdef WITH_OPENSSL
+	&SRNG_backend_aesctr,
+	&SRNG_backend_blowfish,
+#endif
+#ifdef WITH_CRYPTLIB
+	&SRNG_backend_cryptlib,
+#endif
+	NULL
+};
+
+/* Backend state is aligned to this many bytes after the header. */
+#define	STATE_ALIGN	64
+
+/* Size of the look-ahead pool; requests at least this big bypass it. */
+#define	POOL_SIZE	4096
+
+/* The largest seed_size of any backend. */
+#define	MAX_SEED_SIZE	64
+
+/* Hardware RNG device of the seed chain (see SRNG_hwrng). */
+#ifndef SRNG_HWRNG_PATH
+#define	SRNG_HWRNG_PATH	"/dev/hwrng"
+#endif
+
+/* Default reseed policy (see SRNG_reseed_interval). */
+#ifndef SRNG_RESEED_BYTES
+#define	SRNG_RESEED_BYTES	(1ULL << 30)
+#endif
+#ifndef SRNG_RESEED_SECONDS
+#define	SRNG_RESEED_SECONDS	600
+#endif
+
+struct SRNG_st {
+	const struct SRNG_backend *backend;
+	unsigned long long bitbuf;	/* unused bits for SRNG_bits, LSB first */
+	unsigned int nbits;			/* number of valid bits in bitbuf */
+	int have_split_key;
+	unsigned char split_key[CHACHA20_KEY_SIZE];	/* see SRNG_split */
+	struct health_st health;
+	unsigned long long reseed_bytes;	/* 0: no limit */
+	unsigned long long generated;		/* bytes since the last (re)seed */
+	unsigned int reseed_seconds;		/* 0: no limit */
+	time_t seeded_at;					/* monotonic time of the last (re)seed */
+	int reseed_requested;				/* see SRNG_reseed */
+	const char *seed_source;			/* see SRNG_seed_source */
+	unsigned int seed_count;			/* seeds drawn in deterministic mode */
+	unsigned int fork_generation;		/* G_fork_generation when last used */
+	unsigned char seed[MAX_SEED_SIZE];	/* zeroed except while seeding */
+	struct prefill_ring *ring;	/* non-NULL after SRNG_prefill */
+	unsigned char *pool;		/* pool_buf, or the current ring slot */
+	unsigned int pool_idx;		/* next unused byte, POOL_SIZE if empty */
+	unsigned char pool_buf[POOL_SIZE];
+};
+
+/*
+ * Control block at the start of the memory given to SRNG_prefill; the slots
+ * follow it. head and tail are free-running slot counters, written only by
+ * the producer and the consumer, respectively. The *_waiting flags tell the
+ * other side that a wakeup is needed.
+ */
+struct prefill_ring {
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t not_full;
+	pthread_cond_t not_empty;
+	struct SRNG_st *st;
+	unsigned char *slots;
+	unsigned int nslots;		/* a power of 2 */
+	unsigned int low_watermark;	/* producer resumes at this many full slots */
+	unsigned int head;
+	unsigned int tail;
+	int producer_waiting;
+	int consumer_waiting;
+	int stop;
+	int error;					/* exception that stopped the producer */
+};
+
+#define	RING_HEADER_SIZE \
+	((sizeof(struct prefill_ring) + STATE_ALIGN - 1) & ~(STATE_ALIGN - 1))
+
+#define	LOAD(p)		__atomic_load_n((p), __ATOMIC_SEQ_CST)
+#define	STORE(p, v)	__atomic_store_n((p), (v), __ATOMIC_SEQ_CST)
+
+#define	HEADER_SIZE \
+	((sizeof(struct SRNG_st) + STATE_ALIGN - 1) & ~(STATE_ALIGN - 1))
+#define	BACKEND_STATE(st)	((void*)((char*)(st) + HEADER_SIZE))
+
+static const struct SRNG_backend *G_selected;
+static const char *G_egd_path;
+static int G_deterministic;
+static unsigned char G_deterministic_key[CHACHA20_KEY_SIZE];
+static const char *G_hwrng_path = SRNG_HWRNG_PATH;
+
+/* Number of fork()s this process is removed from the first SRNG_init. */
+static unsigned int G_fork_generation = 1;
+static pthread_once_t G_atfork_once = PTHREAD_ONCE_INIT;
+
+static void substream_bytes(void *state, void *buf, unsigned int n)
+{
+	chacha20_rng_bytes(state, buf, n);
+}
+
+/* A child is rekeyed from the seed chain only after fork(). */
+static void substream_get_seed(unsigned char *buf, unsigned int n)
+{
+	fprintf(stderr, "FATAL: no seed source to rekey a substream after fork.\n");
+	Throw(seed_exception);
+}
+
+/* Not in backends[]: only SRNG_split creates states with this backend. */
+static const struct SRNG_backend substream_backend = {
+	"substream", sizeof(struct chacha20_rng), 0, NULL,
+	substream_get_seed, NULL, NULL, substream_bytes, NULL
+};
+
+/* Runs in the (single-threaded) child. */
+static void fork_child(void)
+{
+	G_fork_generation++;
+}
+
+static void register_atfork(void)
+{
+	pthread_atfork(NULL, NULL, fork_child);
+}
+
+static const struct SRNG_backend *default_backend(void)
+{
+	unsigned int i;
+
+	for(i = 0; backends[i]; i++)
+		if((!backends[i]->available || backends[i]->available())
+		&& ((!G_egd_path && !G_deterministic) || backends[i]->seed_size))
+			return backends[i];
+	return backends[0];
+}
+
+int SRNG_select(const char *name)
+{
+	unsigned int i;
+
+	if(!name) {
+		G_selected = default_backend();
+		return G_selected != NULL;
+	}
+
+	for(i = 0; backends[i]; i++) {
+		if(!strcmp(backends[i]->name, name)) {
+			G_selected = backends[i];
+			return 1;
+		}
+	}
+	return 0;
+}
+
+void SRNG_egd(const char *path)
+{
+	G_egd_path = path;
+}
+
+int SRNG_deterministic_seed(const char *path)
+{
+	FILE *fp;
+	size_t n;
+
+	if(!(fp = fopen(path, "rb"))) {
+		perror(path);
+		return 0;
+	}
+	n = fread(G_deterministic_key, 1, sizeof(G_deterministic_key), fp);
+	fclose(fp);
+	if(n < sizeof(G_deterministic_key)) {
+		fprintf(stderr, "ERROR: %s: a seed file must hold at least %u bytes\n",
+				path, (unsigned int)sizeof(G_deterministic_key));
+		return 0;
+	}
+
+	fprintf(stderr,
+		"WARNING: ******************************************************\n"
+		"WARNING: * DETERMINISTIC SEED FROM %s\n"
+		"WARNING: * THE OUTPUT IS NOT RANDOM. NEVER USE IT AS A PASSWORD!\n"
+		"WARNING: ******************************************************\n",
+		path);
+	G_deterministic = 1;
+	return 1;
+}
+
+void SRNG_hwrng(const char *path)
+{
+	G_hwrng_path = path;
+}
+
+const char *SRNG_backend_name(unsigned int i)
+{
+	if(i >= sizeof(backends)/sizeof(*backends) - 1)
+		return NULL;
+	return backends[i]->name;
+}
+
+const char *SRNG_name(const struct SRNG_st *st)
+{
+	return st->backend->name;
+}
+
+const char *SRNG_seed_source(const struct SRNG_st *st)
+{
+	return st->seed_source;
+}
+
+static time_t monotonic_time(void)
+{
+	struct timespec ts;
+
+	if(clock_gettime(CLOCK_MONOTONIC, &ts) < 0) {
+		perror("clock_gettime");
+		Throw(system_call_failed_exception);
+	}
+	return ts.tv_sec;
+}
+
+/*
+ * Read and check n bytes of seed (normally the backend's seed_size) into
+ * st->seed, then mix in the CPU's generator. The health tests see only the
+ * system's seed, which must be good enough on its own.
+ */
+static void gather_seed(struct SRNG_st *st, unsigned int n)
+{
+	if(n && G_deterministic) {
+		/* st->seed has room for a whole block */
+		chacha20_block(G_deterministic_key, st->seed_count++, st->seed);
+		st->seed_source = "deterministic seed";
+	} else if(n) {
+		st->seed_source = seed_read(st->seed, n, G_hwrng_path, G_egd_path);
+		if(!st->seed_source) {
+			st->backend->get_seed(st->seed, n);
+			st->seed_source = st->backend->name;
+		}
+		health_test(&st->health, st->seed, n);
+		cpu_random_mix(st->seed, n);
+	} else {
+		st->seed_source = st->backend->name;
+	}
+}
+
+static void reseed(struct SRNG_st *st)
+{
+	gather_seed(st, st->backend->seed_size);
+	st->backend->reseed(BACKEND_STATE(st), st->seed);
+	memset(st->seed, 0, sizeof(st->seed));
+	st->generated = 0;
+	st->seeded_at = monotonic_time();
+}
+
+/* All calls of backend->bytes go through here, to apply the reseed policy. */
+static void backend_bytes(struct SRNG_st *st, void *buf, unsigned int n)
+{
+	if(st->backend->reseed
+	&& (LOAD(&st->reseed_requested)
+		|| (st->reseed_bytes && st->generated + n > st->reseed_bytes)
+		|| (st->reseed_seconds
+			&& monotonic_time() - st->seeded_at >= st->reseed_seconds))) {
+		STORE(&st->reseed_requested, 0);
+		reseed(st);
+	}
+
+	st->backend->bytes(BACKEND_STATE(st), buf, n);
+	st->generated += n;
+}
+
+/*
+ * Make a state copied by fork() diverge from the parent's copy. Everything
+ * buffered is dropped, and the backend is reseeded, rekeyed or, if it seeds
+ * itself, started anew. A state in secure memory comes zeroed
+ * (MADV_WIPEONFORK) and is simply initialized again.
+ */
+static void after_fork(struct SRNG_st *st)
+{
+	if(!st->backend) {
+		SRNG_init(st);
+		return;
+	}
+
+	/* the prefill thread stayed in the parent */
+	st->ring = NULL;
+	st->pool = st->pool_buf;
+	memset(st->pool_buf, 0, POOL_SIZE);
+	st->pool_idx = POOL_SIZE;
+	st->bitbuf = 0;
+	st->nbits = 0;
+	memset(st->split_key, 0, sizeof(st->split_key));
+	st->have_split_key = 0;
+	st->fork_generation = LOAD(&G_fork_generation);
+
+	if(st->backend == &substream_backend) {
+		gather_seed(st, CHACHA20_KEY_SIZE);
+		chacha20_rng_reseed(BACKEND_STATE(st), st->seed);
+		memset(st->seed, 0, sizeof(st->seed));
+	} else if(st->backend->reseed) {
+		reseed(st);
+	} else {
+		if(st->backend->destroy)
+			st->backend->destroy(BACKEND_STATE(st));
+		st->backend->init(BACKEND_STATE(st), st->seed);
+	}
+}
+
+#define	CHECK_FORK(st) do { \
+	if((st)->fork_generation != LOAD(&G_fork_generation)) \
+		after_fork(st); \
+} while(0)
+
+unsigned int SRNG_init(struct SRNG_st *st)
+{
+	if(!G_selected && !SRNG_select(NULL)) {
+		fprintf(stderr, "FATAL: no random number generator compiled in.\n");
+		Throw(lib_crypto_exception);
+	}
+
+	if(st) {
+		if((G_egd_path || G_deterministic) && !G_selected->seed_size) {
+			fprintf(stderr, "FATAL: the %s generator can't be seeded by %s.\n",
+					G_selected->name, G_egd_path ? "EGD" : "a file");
+			Throw(seed_exception);
+		}
+
+		memset(st, 0, HEADER_SIZE);
+		st->backend = G_selected;
+		st->pool = st->pool_buf;
+		st->pool_idx = POOL_SIZE;
+		st->reseed_bytes = SRNG_RESEED_BYTES;
+		st->reseed_seconds = G_deterministic ? 0 : SRNG_RESEED_SECONDS;
+		st->fork_generation = LOAD(&G_fork_generation);
+		pthread_once(&G_atfork_once, register_atfork);
+
+		gather_seed(st, st->backend->seed_size);
+		st->backend->init(BACKEND_STATE(st), st->seed);
+		memset(st->seed, 0, sizeof(st->seed));
+		st->seeded_at = monotonic_time();
+	}
+
+	return HEADER_SIZE + G_selected->state_size;
+}
+
+/* log2(n) if n is a power of 2, -1 otherwise. */
+static int log2_exact(unsigned int n)
+{
+	int k = 0;
+
+	if(!n || (n & (n - 1)))
+		return -1;
+	while(n >>= 1)
+		k++;
+	return k;
+}
+
+/* Wake up the other side if it announced that it is waiting. */
+static void ring_wake(
+	struct prefill_ring *r,
+	int *waiting,
+	pthread_cond_t *cond)
+{
+	if(LOAD(waiting)) {
+		pthread_mutex_lock(&r->lock);
+		STORE(waiting, 0);
+		pthread_cond_signal(cond);
+		pthread_mutex_unlock(&r->lock);
+	}
+}
+
+static void *ring_producer(void *arg)
+{
+	struct prefill_ring *r = arg;
+	struct exception_context ec;
+	enum exception_code e;
+	unsigned int head;
+
+	/* the consumer's exception context is not valid in this thread */
+	the_exception_context = &ec;
+	init_exception_context(&ec);
+
+	Try {
+		while(!LOAD(&r->stop)) {
+			head = r->head;
+			if(head - LOAD(&r->tail) == r->nslots) {
+				pthread_mutex_lock(&r->lock);
+				while(!LOAD(&r->stop)
+				&& head - LOAD(&r->tail) > r->low_watermark) {
+					STORE(&r->producer_waiting, 1);
+					if(!LOAD(&r->stop)
+					&& head - LOAD(&r->tail) > r->low_watermark)
+						pthread_cond_wait(&r->not_full, &r->lock);
+				}
+				STORE(&r->producer_waiting, 0);
+				pthread_mutex_unlock(&r->lock);
+				continue;
+			}
+
+			backend_bytes(r->st,
+					r->slots + (head & (r->nslots - 1)) * POOL_SIZE,
+					POOL_SIZE);
+			STORE(&r->head, head + 1);
+			ring_wake(r, &r->consumer_waiting, &r->not_empty);
+		}
+	} Catch(e) {
+		pthread_mutex_lock(&r->lock);
+		STORE(&r->error, e);
+		pthread_cond_signal(&r->not_empty);
+		pthread_mutex_unlock(&r->lock);
+	}
+	return NULL;
+}
+
+/*
+ * Release the slot the pool points into (if any) and make the pool point to
+ * the next full one, waiting for the producer if necessary.
+ */
+static void ring_next(struct SRNG_st *st)
+{
+	struct prefill_ring *r = st->ring;
+	unsigned int tail = r->tail;
+
+	if(st->pool != st->pool_buf) {
+		STORE(&r->tail, ++tail);
+		if(LOAD(&r->head) - tail <= r->low_watermark)
+			ring_wake(r, &r->producer_waiting, &r->not_full);
+	}
+	st->pool = st->pool_buf;
+
+	if(LOAD(&r->head) == tail) {
+		pthread_mutex_lock(&r->lock);
+		while(LOAD(&r->head) == tail && !LOAD(&r->error)) {
+			STORE(&r->consumer_waiting, 1);
+			if(LOAD(&r->head) == tail && !LOAD(&r->error))
+				pthread_cond_wait(&r->not_empty, &r->lock);
+		}
+		STORE(&r->consumer_waiting, 0);
+		pthread_mutex_unlock(&r->lock);
+		if(LOAD(&r->head) == tail)
+			Throw(LOAD(&r->error));
+	}
+
+	st->pool = r->slots + (tail & (r->nslots - 1)) * POOL_SIZE;
+	st->pool_idx = 0;
+}
+
+unsigned int SRNG_prefill(
+	struct SRNG_st *st,
+	void *ring,
+	unsigned int nslots)
+{
+	struct prefill_ring *r = ring;
+	int err;
+
+	if(log2_exact(nslots) < 1)
+		return 0;
+	if(!st || !r)
+		goto end;
+	CHECK_FORK(st);
+
+	memset(r, 0, RING_HEADER_SIZE);
+	r->st = st;
+	r->slots = (unsigned char*)r + RING_HEADER_SIZE;
+	r->nslots = nslots;
+	r->low_watermark = nslots / 2;
+
+	if((err = pthread_mutex_init(&r->lock, NULL))
+	|| (err = pthread_cond_init(&r->not_full, NULL))
+	|| (err = pthread_cond_init(&r->not_empty, NULL))
+	|| (err = secure_thread_create(&r->thread, ring_producer, r))) {
+		errno = err;
+		perror("SRNG_prefill");
+		Throw(system_call_failed_exception);
+	}
+
+	/* from now on, the backend state belongs to the producer */
+	memset(st->pool_buf, 0, POOL_SIZE);
+	st->pool_idx = POOL_SIZE;
+	st->ring = r;
+
+end:
+	return RING_HEADER_SIZE + nslots * POOL_SIZE;
+}
+
+/* Stop the producer and wipe the ring. */
+static void ring_destroy(struct SRNG_st *st)
+{
+	struct prefill_ring *r = st->ring;
+
+	pthread_mutex_lock(&r->lock);
+	STORE(&r->stop, 1);
+	pthread_cond_signal(&r->not_full);
+	pthread_mutex_unlock(&r->lock);
+	pthread_join(r->thread, NULL);
+
+	pthread_cond_destroy(&r->not_empty);
+	pthread_cond_destroy(&r->not_full);
+	pthread_mutex_destroy(&r->lock);
+	memset(r->slots, 0, r->nslots * POOL_SIZE);
+	memset(r, 0, RING_HEADER_SIZE);
+
+	st->ring = NULL;
+	st->pool = st->pool_buf;
+	st->pool_idx = POOL_SIZE;
+}
+
+void SRNG_bytes(
+	struct SRNG_st *st,
+	void *buf,
+	unsigned int n)
+{
+	unsigned char *out = buf;
+	unsigned int chunk;
+
+	CHECK_FORK(st);
+	while(n) {
+		if(st->pool_idx == POOL_SIZE) {
+			if(st->ring) {
+				ring_next(st);
+				continue;
+			}
+			if(n >= POOL_SIZE) {
+				backend_bytes(st, out, n);
+				return;
+			}
+			backend_bytes(st, st->pool, POOL_SIZE);
+			st->pool_idx = 0;
+		}
+
+		chunk = POOL_SIZE - st->pool_idx;
+		if(chunk > n)
+			chunk = n;
+		memcpy(out, st->pool + st->pool_idx, chunk);
+		memset(st->pool + st->pool_idx, 0, chunk);
+		st->pool_idx += chunk; out += chunk; n -= chunk;
+	}
+}
+
+unsigned int SRNG_bits(struct SRNG_st *st, unsigned int k)
+{
+	unsigned int word, r;
+
+	CHECK_FORK(st);
+	if(st->nbits < k) {
+		/*
+		 * SECURITY NOTE: 32 random bits pass through the stack on their
+		 * way to the bit buffer.
+		 */
+		SRNG_bytes(st, &word, sizeof(word));
+		st->bitbuf |= (unsigned long long)word << st->nbits;
+		st->nbits += 32;
+		word = 0;
+	}
+
+	r = st->bitbuf & ((1ULL << k) - 1);
+	st->bitbuf >>= k;
+	st->nbits -= k;
+	return r;
+}
+
+/*
+ * Map a 32-bit random number x to [0, n) with Lemire's method. Returns 0 if
+ * x must be rejected; *threshold caches 2^32 mod n (0 until computed).
+ */
+static int multiply_shift(
+	unsigned int x,
+	unsigned int n,
+	unsigned int *threshold,
+	unsigned int *result)
+{
+	unsigned long long m = (unsigned long long)x * n;
+
+	if((unsigned int)m < n) {
+		if(!*threshold)
+			*threshold = -n % n;
+		if((unsigned int)m < *threshold)
+			return 0;
+	}
+	*result = m >> 32;
+	return 1;
+}
+
+unsigned int SRNG_uniform(struct SRNG_st *st, unsigned int n)
+{
+	unsigned int threshold = 0, r;
+	int k = log2_exact(n);
+
+	if(k >= 0)
+		return k ? SRNG_bits(st, k) : 0;
+	while(!multiply_shift(SRNG_bits(st, 32), n, &threshold, &r))
+		;
+	return r;
+}
+
+void SRNG_uniform_n(
+	struct SRNG_st *st,
+	unsigned int n,
+	unsigned int *out,
+	unsigned int count)
+{
+	unsigned int threshold = 0, i;
+	int k = log2_exact(n);
+
+	if(k >= 0) {
+		for(i = 0; i < count; i++)
+			out[i] = k ? SRNG_bits(st, k) : 0;
+		return;
+	}
+
+	SRNG_bytes(st, out, count * sizeof(*out));
+	for(i = 0; i < count; i++)
+		while(!multiply_shift(out[i], n, &threshold, &out[i]))
+			out[i] = SRNG_bits(st, 32);
+}
+
+unsigned int SRNG_split(
+	struct SRNG_st *parent,
+	struct SRNG_st *child,
+	unsigned int index)
+{
+	if(!child)
+		goto end;
+
+	if(!parent->have_split_key) {
+		SRNG_bytes(parent, parent->split_key, sizeof(parent->split_key));
+		parent->have_split_key = 1;
+	}
+
+	memset(child, 0, HEADER_SIZE);
+	child->backend = &substream_backend;
+	child->seed_source = substream_backend.name;
+	child->fork_generation = LOAD(&G_fork_generation);
+	child->pool = child->pool_buf;
+	child->pool_idx = POOL_SIZE;
+
+	/* the child's pool is scratch space for the derived key */
+	chacha20_block(parent->split_key, index, child->pool);
+	chacha20_rng_init(BACKEND_STATE(child), child->pool);
+	memset(child->pool, 0, CHACHA20_BLOCK_SIZE);
+
+end:
+	return HEADER_SIZE + substream_backend.state_size;
+}
+
+void SRNG_reseed_interval(
+	struct SRNG_st *st,
+	unsigned long long bytes,
+	unsigned int seconds)
+{
+	st->reseed_bytes = bytes;
+	st->reseed_seconds = seconds;
+}
+
+void SRNG_reseed(struct SRNG_st *st)
+{
+	CHECK_FORK(st);
+	STORE(&st->reseed_requested, 1);
+	if(!st->ring && st->backend->reseed) {
+		/* don't hand out anything produced before the reseed */
+		memset(st->pool_buf, 0, POOL_SIZE);
+		st->pool_idx = POOL_SIZE;
+		st->bitbuf = 0;
+		st->nbits = 0;
+		STORE(&st->reseed_requested, 0);
+		reseed(st);
+	}
+}
+
+void SRNG_destroy(struct SRNG_st *st)
+{
+	if(!st->backend)	/* wiped by fork() and never used since */
+		return;
+	if(st->backend != &substream_backend)
+		fprintf(stderr, "INFO: destroying random number generator.\n");
+	if(st->fork_generation != LOAD(&G_fork_generation))
+		st->ring = NULL;	/* its thread is the parent's */
+	if(st->ring)
+		ring_destroy(st);
+	if(st->backend->destroy)
+		st->backend->destroy(BACKEND_STATE(st));
+	memset(st, 0, HEADER_SIZE + st->backend->state_size);
+}
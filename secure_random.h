@@ -32,6 +32,65 @@
 /** Opaque structure used to hold secure random generator state. */
 struct SRNG_st;
 
+/**
+	Select the generator (backend) used by subsequent SRNG_init() calls.
+
+	@param	name	Backend name as returned by SRNG_backend_name(), or NULL
+					to select the best backend available on this host.
+	@return	0 if there is no such backend, 1 otherwise.
+
+	@note	If this is never called, SRNG_init() selects the default.
+*/
+int SRNG_select(const char *name);
+
+/**
+	Seed sources are tried in this order, each within its own time budget:
+	getrandom(2) without blocking, the hardware RNG device, the EGD socket
+	and finally the backend's own source (e.g. RAND_bytes), which may
+	block. Backends that seed themselves (vgetrandom, cryptlib) skip the
+	chain.
+
+	Set the UNIX socket of the EGD (entropy gathering daemon), e.g. for
+	systems without /dev/urandom; NULL (the default) skips EGD. Must be
+	called before SRNG_init(); the default backend is then the first one
+	that takes a seed.
+*/
+void SRNG_egd(const char *path);
+
+/**
+	INSECURE: seed every generator initialized from now on from the first
+	CHACHA20_KEY_SIZE (32) bytes of the file \e path instead of the seed
+	sources, so that it replays the same stream on every run; meant for
+	benchmarks and known-answer tests only. A warning is printed. The
+	default backend is then the first one that takes a seed.
+
+	@return	0 if the file can't be read or is too short, 1 otherwise.
+*/
+int SRNG_deterministic_seed(const char *path);
+
+/**
+	Set the hardware RNG device of the seed chain, /dev/hwrng by default
+	(SRNG_HWRNG_PATH at compile time); NULL skips it.
+*/
+void SRNG_hwrng(const char *path);
+
+/**
+	@return	Name of the i-th compiled-in backend, or NULL if \e i is past
+			the last one. Backends are listed in order of preference.
+*/
+const char *SRNG_backend_name(unsigned int i);
+
+/** @return	Name of the backend used by an initialized state. */
+const char *SRNG_name(const struct SRNG_st *st);
+
+/**
+	@return	Where the last seed of \e st came from: "getrandom", the path of
+			the hardware RNG device, "EGD", "deterministic seed" or, if
+			the backend seeded itself (or is a child of SRNG_split), its
+			name.
+*/
+const char *SRNG_seed_source(const struct SRNG_st *st);
+
 /**
 	Initialize the secure random number generator.
 	@param	st	The state variable which should be initialized. The behaviour
@@ -43,7 +102,7 @@ struct SRNG_st;
 	@note	The interface is designed such that it is possible to provide a
 			secure (e.g. memory-locked) buffer for the state. If \e st is
 			NULL, the function does nothing, but still returns the size that
-			needs to be reserved for the state.
+			needs to be reserved for the state of the selected backend.
 */
 unsigned int SRNG_init(struct SRNG_st *st);
 
@@ -55,12 +114,131 @@ unsigned int SRNG_init(struct SRNG_st *st);
 	@param	n		Number of random bytes to retrieve.
 
 	An exception is thrown on error.
+
+	@note	A state copied by fork() is reseeded automatically on its next
+			use in the child (a child of SRNG_split is rekeyed from the seed
+			sources), and the random bytes buffered before the fork are
+			dropped, so parent and children never return the same output.
+			A prefill thread is not carried over into the child.
 */
 void SRNG_bytes(
 	struct SRNG_st *st,
 	void *buf,
 	unsigned int n);
 
+/**
+	Obtain \e k random bits from the generator.
+
+	@param	st		Pointer to generator state.
+	@param	k		Number of bits, 1 to 32.
+	@return	A uniformly distributed number in [0, 2^k).
+
+	Bits are taken from the generator 32 at a time and handed out without
+	waste, so k-bit draws cost k bits of generator output.
+
+	An exception is thrown on error.
+*/
+unsigned int SRNG_bits(struct SRNG_st *st, unsigned int k);
+
+/**
+	Obtain a uniformly distributed random number in [0, \e n).
+
+	@param	st		Pointer to generator state.
+	@param	n		Size of the range, at least 1.
+
+	Uses Lemire's multiply-shift method: a 32-bit random number is
+	multiplied by \e n and the high half of the product is the result. The
+	few products that would introduce a bias are rejected, which happens
+	with probability less than n/2^32, and no division is needed unless the
+	low half of the product is below \e n. Powers of two cost exactly
+	log2(n) bits.
+
+	An exception is thrown on error.
+*/
+unsigned int SRNG_uniform(struct SRNG_st *st, unsigned int n);
+
+/**
+	Fill \e out with \e count uniformly distributed random numbers in
+	[0, \e n). Equivalent to calling SRNG_uniform() \e count times, but
+	the random numbers are fetched from the generator in one request.
+
+	An exception is thrown on error.
+*/
+void SRNG_uniform_n(
+	struct SRNG_st *st,
+	unsigned int n,
+	unsigned int *out,
+	unsigned int count);
+
+/**
+	Derive an independent child generator from \e parent.
+
+	@param	parent	Initialized generator state.
+	@param	child	State to initialize, or NULL.
+	@param	index	Index of the child.
+	@return	The size that needs to be reserved for the child state.
+
+	The first call draws a 256-bit split key from \e parent. The key of
+	child \e index is ChaCha20 keystream block \e index under the split key,
+	and the child is a ChaCha20 generator of its own. Children can thus be
+	used concurrently, e.g. one per thread, without any locking, and none
+	of them can be used to predict the parent or another child. Children
+	with the same index produce the same stream, so use each index once.
+
+	The child is destroyed with SRNG_destroy(). An exception is thrown on
+	error.
+*/
+unsigned int SRNG_split(
+	struct SRNG_st *parent,
+	struct SRNG_st *child,
+	unsigned int index);
+
+/**
+	Set the reseed policy of \e st: the backend is reseeded after it has
+	produced \e bytes bytes or after \e seconds seconds, whichever comes
+	first; 0 turns the respective limit off. The defaults are 1 GiB and 10
+	minutes (SRNG_RESEED_BYTES and SRNG_RESEED_SECONDS at compile time).
+	Backends that seed themselves (vgetrandom, cryptlib) ignore the policy.
+*/
+void SRNG_reseed_interval(
+	struct SRNG_st *st,
+	unsigned long long bytes,
+	unsigned int seconds);
+
+/**
+	Reseed the backend now, discarding buffered random bytes. With an
+	active prefill thread the reseed is done by the thread before it fills
+	the next slot, and the slots already filled are still handed out. An
+	exception is thrown on error, e.g. if the seed material fails the
+	health tests.
+*/
+void SRNG_reseed(struct SRNG_st *st);
+
+/**
+	Move the generator's cipher work to a background thread.
+
+	@param	st		Initialized generator state, or NULL.
+	@param	ring	Memory for the ring of random blocks, or NULL.
+	@param	nslots	Number of 4096-byte slots in the ring; a power of 2, at
+					least 2.
+	@return	The size that needs to be reserved for \e ring, or 0 if
+			\e nslots is invalid.
+
+	The thread keeps the ring full, pauses when it is full and resumes
+	when the consumer has emptied half of it. SRNG_bytes() and the
+	functions built on it then only copy from the ring. Like the state,
+	\e ring should be in locked memory; consumed bytes are zeroed.
+
+	Only the thread that owns \e st may call the other SRNG functions on
+	it. SRNG_destroy() stops the thread and wipes the ring. An exception
+	is thrown if the thread can't be created; an exception in the thread
+	is thrown again by the SRNG_bytes() call that finds the ring empty.
+*/
+unsigned int SRNG_prefill(
+	struct SRNG_st *st,
+	void *ring,
+	unsigned int nslots);
+
 /**
  * Destroy the RNG state. \e st is pointer returned by SRNG_init().
  */
@@ -0,0 +1,95 @@
+/*
+  secure_random_backend.h - interface implemented by the SRNG backends
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef SECURE_RANDOM_BACKEND_H__
+#define SECURE_RANDOM_BACKEND_H__
+
+/**
+	@file
+	Every secure_random_*.c file implements one generator and exports it
+	as a struct SRNG_backend. secure_random.c holds the table of compiled-in
+	backends and dispatches the SRNG interface to the selected one. The
+	backend state is stored in the secure memory right after the dispatcher's
+	own part of struct SRNG_st.
+
+	Seed material is gathered by the dispatcher, which runs the health
+	tests on it before passing it to init or reseed. Backends built on a
+	generator that seeds itself (the kernel, cryptlib) have seed_size 0.
+*/
+
+struct SRNG_backend {
+	/** Name used with --rng=NAME. */
+	const char *name;
+
+	/** Number of bytes of state the backend needs. */
+	unsigned int state_size;
+
+	/** Number of bytes of seed material taken by init and reseed. */
+	unsigned int seed_size;
+
+	/**
+		Return non-0 if the backend may be picked as the default on this
+		host. NULL means always. An explicitly selected backend is used even
+		if this returns 0.
+	*/
+	int (*available)(void);
+
+	/**
+		Read \e n bytes of seed material from the backend's own entropy
+		source; NULL if seed_size is 0. An exception is thrown on error.
+	*/
+	void (*get_seed)(unsigned char *buf, unsigned int n);
+
+	/**
+		Initialize \e state from seed_size bytes of \e seed (ignored if
+		seed_size is 0). An exception is thrown on error.
+	*/
+	void (*init)(void *state, const unsigned char *seed);
+
+	/**
+		Mix seed_size bytes of fresh \e seed into \e state; NULL if the
+		backend can't be reseeded. An exception is thrown on error.
+	*/
+	void (*reseed)(void *state, const unsigned char *seed);
+
+	/** Obtain \e n random bytes. An exception is thrown on error. */
+	void (*bytes)(void *state, void *buf, unsigned int n);
+
+	/**
+		Release resources held outside of \e state; may be NULL. The state
+		itself is zeroed by the caller.
+	*/
+	void (*destroy)(void *state);
+};
+
+extern const struct SRNG_backend SRNG_backend_blowfish;
+extern const struct SRNG_backend SRNG_backend_chacha20;
+extern const struct SRNG_backend SRNG_backend_aesctr;
+extern const struct SRNG_backend SRNG_backend_cryptlib;
+extern const struct SRNG_backend SRNG_backend_getrandom;
+extern const struct SRNG_backend SRNG_backend_vgetrandom;
+
+/** get_seed of the OpenSSL backends: RAND_bytes. */
+void SRNG_openssl_seed(unsigned char *buf, unsigned int n);
+
+#endif	/* SECURE_RANDOM_BACKEND_H__ */
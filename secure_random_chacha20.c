@@ -0,0 +1,71 @@
+/*
+  secure_random_chacha20.c - ChaCha20 secure random number generator
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "chacha20.h"
+#include "secure_random_backend.h"
+#include "exceptions.h"
+
+/**
+	@file
+	This implementation takes a 256-bit seed from OpenSSL's RAND_bytes and
+	expands it with the ChaCha20 generator in chacha20.c. Keystream is
+	produced CHACHA20_RNG_BUFSIZE bytes at a time, and the key is replaced
+	by fresh keystream on every refill, so the state never holds anything
+	from which earlier output could be recomputed.
+*/
+
+struct chacha20_st {
+	struct chacha20_rng rng;
+};
+
+static void chacha20_init(void *state, const unsigned char *seed)
+{
+	struct chacha20_st *st = state;
+
+	chacha20_rng_init(&st->rng, seed);
+}
+
+static void chacha20_reseed(void *state, const unsigned char *seed)
+{
+	struct chacha20_st *st = state;
+
+	chacha20_rng_reseed(&st->rng, seed);
+}
+
+static void chacha20_bytes(
+	void *state,
+	void *buf,
+	unsigned int n)
+{
+	struct chacha20_st *st = state;
+
+	chacha20_rng_bytes(&st->rng, buf, n);
+}
+
+const struct SRNG_backend SRNG_backend_chacha20 = {
+	"chacha20", sizeof(struct chacha20_st), CHACHA20_KEY_SIZE, NULL,
+	SRNG_openssl_seed, chacha20_init, chacha20_reseed, chacha20_bytes, NULL
+};
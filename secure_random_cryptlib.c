@@ -24,8 +24,8 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <assert.h>
 #include <cryptlib.h>
+#include "secure_random_backend.h"
 #include "exceptions.h"
 
 static char rcsid[] = "$Id: secure_random_cryptlib.c 1 2005-11-13 20:23:40Z zvrba $";
@@ -33,11 +33,22 @@ static char rcsid[] = "$Id: secure_random_cryptlib.c 1 2005-11-13 20:23:40Z zvrb
 /**
 	@file
 	Cryptlib random number generator.
+
+	The output is the RC4 keystream of a context keyed by cryptlib's own
+	generator, obtained by encrypting zeros. Requests of at least BUF_SIZE
+	bytes are encrypted in place in the caller's buffer in chunks of up to
+	MAX_CHUNK bytes. Smaller requests are served from a BUF_SIZE buffer of
+	keystream whose unused part is kept for the next call; handed out bytes
+	are zeroed.
 */
 
-struct SRNG_st {
+#define	BUF_SIZE	4096
+#define	MAX_CHUNK	(1U << 20)
+
+struct cryptlib_st {
 	CRYPT_CONTEXT ctx;
-	char rnd[64];
+	unsigned int idx;	/* next unused byte in rnd, BUF_SIZE if empty */
+	char rnd[BUF_SIZE];
 };
 
 #define	CALL_CL(func, ...) do { \
@@ -48,36 +59,65 @@ struct SRNG_st {
 	} \
 } while(0)
 
-unsigned int SRNG_init(struct SRNG_st *st)
+static void cryptlib_init(void *state, const unsigned char *seed)
 {
-	if(!st)
-		goto end;
+	struct cryptlib_st *st = state;
 
 	CALL_CL(cryptInit);
 	CALL_CL(cryptAddRandom, NULL, CRYPT_RANDOM_SLOWPOLL);
 	CALL_CL(cryptCreateContext, &st->ctx, CRYPT_UNUSED, CRYPT_ALGO_RC4);
 	CALL_CL(cryptGenerateKey, st->ctx);
+	st->idx = BUF_SIZE;
+}
 
-end:
-	return sizeof(struct SRNG_st);
+/* Write n bytes of keystream to out. */
+static void keystream(struct cryptlib_st *st, char *out, unsigned int n)
+{
+	memset(out, 0, n);
+	CALL_CL(cryptEncrypt, st->ctx, out, n);
 }
 
-void SRNG_bytes(
-	struct SRNG_st *st,
+static void cryptlib_bytes(
+	void *state,
 	void *buf,
 	unsigned int n)
 {
-	assert(n < sizeof(st->rnd));
-	CALL_CL(cryptEncrypt, st->ctx, st->rnd, sizeof(st->rnd));
-	memcpy(buf, st->rnd, n);
+	struct cryptlib_st *st = state;
+	char *out = buf;
+	unsigned int chunk;
+
+	while(n) {
+		if(st->idx == BUF_SIZE) {
+			if(n >= BUF_SIZE) {
+				chunk = n < MAX_CHUNK ? n : MAX_CHUNK;
+				keystream(st, out, chunk);
+				out += chunk; n -= chunk;
+				continue;
+			}
+			keystream(st, st->rnd, BUF_SIZE);
+			st->idx = 0;
+		}
+
+		chunk = BUF_SIZE - st->idx;
+		if(chunk > n)
+			chunk = n;
+		memcpy(out, st->rnd + st->idx, chunk);
+		memset(st->rnd + st->idx, 0, chunk);
+		st->idx += chunk; out += chunk; n -= chunk;
+	}
 }
 
-void SRNG_destroy(struct SRNG_st *st)
+static void cryptlib_destroy(void *state)
 {
-	printf("INFO: destroying random number generator.\n");
+	struct cryptlib_st *st = state;
+
 	CALL_CL(cryptDestroyContext, st->ctx);
 	if(cryptEnd() != CRYPT_OK) {
 		fprintf(stderr, "ERROR: some garbage left to cryptlib.");
 	}
-	memset(st, 0, sizeof(*st));
 }
+
+const struct SRNG_backend SRNG_backend_cryptlib = {
+	"cryptlib", sizeof(struct cryptlib_st), 0, NULL,
+	NULL, cryptlib_init, NULL, cryptlib_bytes, cryptlib_destroy
+};
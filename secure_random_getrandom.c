@@ -0,0 +1,115 @@
+/*
+  secure_random_getrandom.c - secure random number generator using getrandom
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/random.h>
+#include "chacha20.h"
+#include "secure_random_backend.h"
+#include "exceptions.h"
+
+/**
+	@file
+	This implementation needs no crypto library. The 256-bit key is read
+	from the kernel with getrandom(2) (or from /dev/urandom on kernels that
+	lack the system call) and expanded with the ChaCha20 generator in
+	chacha20.c. It is meant for small, statically linked binaries.
+*/
+
+struct getrandom_st {
+	struct chacha20_rng rng;
+};
+
+static void read_urandom(unsigned char *buf, unsigned int n)
+{
+	ssize_t ret;
+	int fd;
+
+	if((fd = open("/dev/urandom", O_RDONLY)) < 0) {
+		perror("/dev/urandom");
+		Throw(system_call_failed_exception);
+	}
+	while(n) {
+		if((ret = read(fd, buf, n)) <= 0) {
+			if(ret < 0 && errno == EINTR)
+				continue;
+			perror("/dev/urandom");
+			close(fd);
+			Throw(system_call_failed_exception);
+		}
+		buf += ret; n -= ret;
+	}
+	close(fd);
+}
+
+static void get_seed(unsigned char *buf, unsigned int n)
+{
+	ssize_t ret;
+
+	while(n) {
+		if((ret = getrandom(buf, n, 0)) < 0) {
+			if(errno == EINTR)
+				continue;
+			if(errno == ENOSYS) {
+				read_urandom(buf, n);
+				return;
+			}
+			perror("getrandom");
+			Throw(system_call_failed_exception);
+		}
+		buf += ret; n -= ret;
+	}
+}
+
+static void getrandom_init(void *state, const unsigned char *seed)
+{
+	struct getrandom_st *st = state;
+
+	chacha20_rng_init(&st->rng, seed);
+}
+
+static void getrandom_reseed(void *state, const unsigned char *seed)
+{
+	struct getrandom_st *st = state;
+
+	chacha20_rng_reseed(&st->rng, seed);
+}
+
+static void getrandom_bytes(
+	void *state,
+	void *buf,
+	unsigned int n)
+{
+	struct getrandom_st *st = state;
+
+	chacha20_rng_bytes(&st->rng, buf, n);
+}
+
+const struct SRNG_backend SRNG_backend_getrandom = {
+	"getrandom", sizeof(struct getrandom_st), CHACHA20_KEY_SIZE, NULL,
+	get_seed, getrandom_init, getrandom_reseed, getrandom_bytes, NULL
+};
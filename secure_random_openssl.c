@@ -26,6 +26,7 @@
 #include <openssl/err.h>
 #include <openssl/rand.h>
 #include <openssl/blowfish.h>
+#include "secure_random_backend.h"
 #include "exceptions.h"
 
 static char rcsid[] = "$Id: secure_random_openssl.c 1 2005-11-13 20:23:40Z zvrba $";
@@ -39,43 +40,67 @@ static char rcsid[] = "$Id: secure_random_openssl.c 1 2005-11-13 20:23:40Z zvrba
 	The generator gathers a small amount of true randomness from the system and
 	uses it to initialize the blowfish key and the randomness buffer. Further
 	random bytes are obtained by encrypting the previous contents of the
-	random buffer.
+	random buffer. A reseed XORs fresh seed material into the key (together
+	with generator output) and into the buffer.
+
+	This file also provides the RAND_bytes seed source for all OpenSSL
+	backends.
 */
 
 /* Blowfish parameters. */
 #define	KEY_SIZE	16	/* 128-bit key size */
 #define BLOCK_SIZE	8	/* 64-bit block size */
 
-struct SRNG_st {
+#define	SEED_SIZE	(KEY_SIZE+2*BLOCK_SIZE)
+
+struct blowfish_st {
 	BF_KEY key;
 	unsigned char rnd[2*BLOCK_SIZE];
 	unsigned int idx;
 	unsigned char keydata[KEY_SIZE];
 };
 
-unsigned int SRNG_init(struct SRNG_st *st)
-{
-	if(!st)
-		goto end;
+static void blowfish_bytes(void *state, void *buf, unsigned int n);
 
-	if(!RAND_bytes(st->keydata, sizeof(st->keydata))
-	|| !RAND_bytes(st->rnd, sizeof(st->rnd))) {
+void SRNG_openssl_seed(unsigned char *buf, unsigned int n)
+{
+	if(!RAND_bytes(buf, n)) {
 		ERR_print_errors_fp(stderr);
 		Throw(lib_crypto_exception);
 	}
+}
+
+static void blowfish_init(void *state, const unsigned char *seed)
+{
+	struct blowfish_st *st = state;
 
+	memcpy(st->keydata, seed, KEY_SIZE);
+	memcpy(st->rnd, seed + KEY_SIZE, sizeof(st->rnd));
 	BF_set_key(&st->key, sizeof(st->keydata), st->keydata);
+	memset(st->keydata, 0, sizeof(st->keydata));
 	st->idx = 0;
+}
 
-end:
-	return sizeof(struct SRNG_st);
+static void blowfish_reseed(void *state, const unsigned char *seed)
+{
+	struct blowfish_st *st = state;
+	unsigned int i;
+
+	blowfish_bytes(st, st->keydata, sizeof(st->keydata));
+	for(i = 0; i < KEY_SIZE; i++)
+		st->keydata[i] ^= seed[i];
+	for(i = 0; i < sizeof(st->rnd); i++)
+		st->rnd[i] ^= seed[KEY_SIZE + i];
+	BF_set_key(&st->key, sizeof(st->keydata), st->keydata);
+	memset(st->keydata, 0, sizeof(st->keydata));
 }
 
-void SRNG_bytes(
-	struct SRNG_st *st,
+static void blowfish_bytes(
+	void *state,
 	void *buf,
 	unsigned int n)
 {
+	struct blowfish_st *st = state;
 	unsigned char *out = buf, *src, *dst;
 
 	while(1) {
@@ -100,8 +125,7 @@ void SRNG_bytes(
 	}
 }
 
-void SRNG_destroy(struct SRNG_st *st)
-{
-	printf("INFO: destroying random number generator.\n");
-	memset(st, 0, sizeof(*st));
-}
+const struct SRNG_backend SRNG_backend_blowfish = {
+	"blowfish", sizeof(struct blowfish_st), SEED_SIZE, NULL,
+	SRNG_openssl_seed, blowfish_init, blowfish_reseed, blowfish_bytes, NULL
+};
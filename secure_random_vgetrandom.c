@@ -0,0 +1,233 @@
+/*
+  secure_random_vgetrandom.c - secure random number generator using the
+  getrandom vDSO function of the Linux kernel
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <errno.h>
+#include <unistd.h>
+#include <elf.h>
+#include <link.h>
+#include <sys/auxv.h>
+#include <sys/random.h>
+#include "secure_random_backend.h"
+#include "exceptions.h"
+
+/**
+	@file
+	This implementation has no generator of its own: every request is
+	served by the kernel's CSPRNG. On kernels that export getrandom in the
+	vDSO (Linux 6.11 and later) the request is answered in user space, from
+	a per-caller opaque state, without entering the kernel. The opaque
+	state is placed inside the backend state, i.e. in the locked secure
+	memory. Without the vDSO function every request is a getrandom(2) system
+	call, and the backend is not picked as the default.
+
+	@note	The kernel only notices a fork() if the opaque state is wiped in
+			the child. The dispatcher sees to that: in secure memory the
+			state is MADV_WIPEONFORK, and a state elsewhere is caught by its
+			fork generation on first use and initialized again, which
+			zeroes the opaque state (see after_fork in secure_random.c).
+*/
+
+/* Layout defined by the kernel (include/uapi/linux/random.h). */
+struct vgetrandom_opaque_params {
+	uint32_t size_of_opaque_state;
+	uint32_t mmap_prot;
+	uint32_t mmap_flags;
+	uint32_t reserved[13];
+};
+
+typedef ssize_t (*vgetrandom_fn)(void *buffer, size_t len,
+		unsigned int flags, void *opaque_state, size_t opaque_len);
+
+/*
+ * The opaque state must not cross a page boundary. OPAQUE_AREA leaves room
+ * to move a state of up to (OPAQUE_AREA - 64)/2 bytes to the next page.
+ */
+#define	OPAQUE_AREA		1024
+
+struct vgetrandom_st {
+	vgetrandom_fn vgetrandom;
+	unsigned char *opaque;
+	size_t opaque_len;
+	unsigned char area[OPAQUE_AREA];
+};
+
+/*
+ * The ELF32_ or ELF64_ macro matching ElfW(), e.g. ELFW(ST_TYPE); the C
+ * library only provides the latter.
+ */
+#ifndef ELFW
+#if UINTPTR_MAX > 0xffffffffU
+#define	ELFW(name)	ELF64_ ## name
+#else
+#define	ELFW(name)	ELF32_ ## name
+#endif
+#endif
+
+/*
+ * Find a function exported by the vDSO. Only the DT_HASH table is used for
+ * the symbol count; symbol versions are not checked since each name is
+ * only defined once.
+ */
+static void *vdso_lookup(const char *name)
+{
+	const ElfW(Ehdr) *eh;
+	const ElfW(Phdr) *ph;
+	const ElfW(Dyn) *dyn = NULL;
+	const ElfW(Sym) *symtab = NULL;
+	const char *strtab = NULL;
+	const ElfW(Word) *hash = NULL;
+	uintptr_t base, load_offset = 0;
+	unsigned int i;
+
+	if(!(base = getauxval(AT_SYSINFO_EHDR)))
+		return NULL;
+
+	eh = (const ElfW(Ehdr)*)base;
+	ph = (const ElfW(Phdr)*)(base + eh->e_phoff);
+	for(i = 0; i < eh->e_phnum; i++) {
+		if(ph[i].p_type == PT_LOAD && !load_offset)
+			load_offset = base + ph[i].p_offset - ph[i].p_vaddr;
+		else if(ph[i].p_type == PT_DYNAMIC)
+			dyn = (const ElfW(Dyn)*)(base + ph[i].p_offset);
+	}
+	if(!dyn || !load_offset)
+		return NULL;
+
+	for(; dyn->d_tag != DT_NULL; dyn++) {
+		switch(dyn->d_tag) {
+		case DT_STRTAB:
+			strtab = (const char*)(load_offset + dyn->d_un.d_ptr);
+			break;
+		case DT_SYMTAB:
+			symtab = (const ElfW(Sym)*)(load_offset + dyn->d_un.d_ptr);
+			break;
+		case DT_HASH:
+			hash = (const ElfW(Word)*)(load_offset + dyn->d_un.d_ptr);
+			break;
+		}
+	}
+	if(!strtab || !symtab || !hash)
+		return NULL;
+
+	/* hash[1] is nchain, the number of symbol table entries */
+	for(i = 0; i < hash[1]; i++) {
+		if(ELFW(ST_TYPE)(symtab[i].st_info) != STT_FUNC
+		|| symtab[i].st_shndx == SHN_UNDEF)
+			continue;
+		if(!strcmp(strtab + symtab[i].st_name, name))
+			return (void*)(load_offset + symtab[i].st_value);
+	}
+	return NULL;
+}
+
+static vgetrandom_fn find_vgetrandom(void)
+{
+	static const char *names[] = { "__vdso_getrandom", "__kernel_getrandom" };
+	vgetrandom_fn fn = NULL;
+	unsigned int i;
+
+	for(i = 0; i < sizeof(names)/sizeof(*names) && !fn; i++)
+		fn = (vgetrandom_fn)vdso_lookup(names[i]);
+	return fn;
+}
+
+static int vgetrandom_available(void)
+{
+	return find_vgetrandom() != NULL;
+}
+
+static void setup_vdso(struct vgetrandom_st *st)
+{
+	struct vgetrandom_opaque_params params;
+	vgetrandom_fn fn;
+	uintptr_t p, pagesize = sysconf(_SC_PAGESIZE);
+
+	if(!(fn = find_vgetrandom()))
+		return;
+
+	/* the special call with opaque_len == ~0 only fills params */
+	if(fn(NULL, 0, 0, &params, ~(size_t)0) != 0)
+		return;
+
+	p = ((uintptr_t)st->area + 63) & ~(uintptr_t)63;
+	if((p & (pagesize-1)) + params.size_of_opaque_state > pagesize)
+		p = (p + pagesize - 1) & ~(pagesize - 1);
+	if(p + params.size_of_opaque_state > (uintptr_t)(st->area + OPAQUE_AREA))
+		return;
+
+	st->vgetrandom = fn;
+	st->opaque = (unsigned char*)p;
+	st->opaque_len = params.size_of_opaque_state;
+}
+
+static void vgetrandom_init(void *state, const unsigned char *seed)
+{
+	struct vgetrandom_st *st = state;
+
+	memset(st, 0, sizeof(*st));
+	setup_vdso(st);
+	if(!st->vgetrandom)
+		fprintf(stderr,
+				"INFO: vDSO getrandom not available, using getrandom(2).\n");
+}
+
+static void vgetrandom_bytes(
+	void *state,
+	void *buf,
+	unsigned int n)
+{
+	struct vgetrandom_st *st = state;
+	unsigned char *out = buf;
+	ssize_t ret;
+
+	while(n) {
+		if(st->vgetrandom) {
+			/* the vDSO returns -errno instead of setting errno */
+			ret = st->vgetrandom(out, n, 0, st->opaque, st->opaque_len);
+			if(ret < 0) {
+				errno = -ret;
+				ret = -1;
+			}
+		} else {
+			ret = getrandom(out, n, 0);
+		}
+
+		if(ret < 0) {
+			if(errno == EINTR)
+				continue;
+			perror("getrandom");
+			Throw(system_call_failed_exception);
+		}
+		out += ret; n -= ret;
+	}
+}
+
+const struct SRNG_backend SRNG_backend_vgetrandom = {
+	"vgetrandom", sizeof(struct vgetrandom_st), 0, vgetrandom_available,
+	NULL, vgetrandom_init, NULL, vgetrandom_bytes, NULL
+};
@@ -0,0 +1,106 @@
+/*
+  seed.c - the chain of seed sources
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/random.h>
+#endif
+#include "seed.h"
+#include "egd.h"
+
+/*
+ * Longest sleep while waiting for the device. Not every hw_random driver
+ * supports poll(), so a read that would block is retried at this interval
+ * instead of spinning.
+ */
+#define	HWRNG_RETRY_MS	10
+
+/* Fails at once (EAGAIN) until the kernel pool is initialized. */
+static int read_getrandom(unsigned char *buf, unsigned int n)
+{
+#ifdef GRND_NONBLOCK
+	ssize_t ret;
+
+	while(n) {
+		if((ret = getrandom(buf, n, GRND_NONBLOCK)) < 0) {
+			if(errno == EINTR)
+				continue;
+			return -1;
+		}
+		buf += ret; n -= ret;
+	}
+	return 0;
+#else
+	return -1;
+#endif
+}
+
+static int read_hwrng(const char *path, unsigned char *buf, unsigned int n)
+{
+	long long deadline = egd_now_ms() + HWRNG_TIMEOUT;
+	struct pollfd pfd;
+	long long left;
+	ssize_t ret;
+	int fd;
+
+	if((fd = open(path, O_RDONLY | O_NONBLOCK)) < 0)
+		return -1;
+
+	while(n) {
+		if((ret = read(fd, buf, n)) > 0) {
+			buf += ret; n -= ret;
+			continue;
+		}
+		/* 0 is a FIFO without a writer, which may yet come */
+		if(ret < 0 && errno != EAGAIN && errno != EINTR)
+			break;
+		if((left = deadline - egd_now_ms()) <= 0)
+			break;
+		pfd.fd = fd;
+		pfd.events = POLLIN;
+		poll(&pfd, 1, left < HWRNG_RETRY_MS ? (int)left : HWRNG_RETRY_MS);
+	}
+
+	close(fd);
+	return n ? -1 : 0;
+}
+
+const char *seed_read(
+	unsigned char *buf,
+	unsigned int n,
+	const char *hwrng,
+	const char *egd)
+{
+	if(!read_getrandom(buf, n))
+		return "getrandom";
+	if(hwrng && !read_hwrng(hwrng, buf, n))
+		return hwrng;
+	if(egd && !egd_read(egd, buf, n))
+		return "EGD";
+	return NULL;
+}
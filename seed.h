@@ -0,0 +1,55 @@
+/*
+  seed.h - the chain of seed sources
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+#ifndef SEED_H__
+#define SEED_H__
+
+/**
+ * @file
+ * The seed sources tried before a backend's own, in this order:
+ * getrandom(2) without blocking, a hardware RNG device (/dev/hwrng) and
+ * EGD. Each source has its own time budget, so one that is not ready (the
+ * kernel pool right after boot, a slow device, a stuck daemon) delays
+ * seeding by at most that long before the next one is tried.
+ */
+
+/** Time budget of the hardware RNG device, in milliseconds. */
+#ifndef HWRNG_TIMEOUT
+#define	HWRNG_TIMEOUT	500
+#endif
+
+/**
+ * Fill \e buf with \e n bytes from the first source that delivers them in
+ * time. \e hwrng is the path of the hardware RNG device and \e egd that of
+ * the EGD socket; NULL skips the respective source.
+ *
+ * @return Name of the source used, or NULL if none delivered, in which
+ *         case the contents of \e buf are undefined.
+ */
+const char *seed_read(
+	unsigned char *buf,
+	unsigned int n,
+	const char *hwrng,
+	const char *egd);
+
+#endif	/* SEED_H__ */
@@ -0,0 +1,157 @@
+/*
+  bench.c - throughput of the generators, health tests and reseeding
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+ * USAGE: bench RNG [CHUNK]
+ *
+ * Measures, best of BENCH_RUNS runs each:
+ *  - the health tests on seed material (health_test), in MB/s;
+ *  - one forced reseed (SRNG_reseed): seed read, health tests and backend
+ *    rekeying, in microseconds;
+ *  - BENCH_BYTES of output through SRNG_bytes in CHUNK byte requests
+ *    (default 32), at the default reseed policy, with the policy off and
+ *    with a 1 MiB interval, in MB/s.
+ * Build with optimization (make clean bench CC="cc -O2") and run on an
+ * otherwise idle CPU; differences of a few percent are noise.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../secure_random.h"
+#include "../health.h"
+#include "../exceptions.h"
+
+#define	BENCH_RUNS		5
+#define	BENCH_BYTES		(256ULL << 20)
+#define	BENCH_RESEEDS	1000
+#define	BENCH_BUF		65536
+
+static struct exception_context exception_context;
+__thread struct exception_context *the_exception_context =
+	&exception_context;
+
+static unsigned char buf[BENCH_BUF];
+
+static double now(void)
+{
+	struct timespec ts;
+
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return ts.tv_sec + ts.tv_nsec * 1e-9;
+}
+
+static double bench_health(struct SRNG_st *st)
+{
+	struct health_st h;
+	double t, best = 1e9;
+	unsigned long long n;
+	int run;
+
+	SRNG_bytes(st, buf, sizeof(buf));
+	for(run = 0; run < BENCH_RUNS; run++) {
+		memset(&h, 0, sizeof(h));
+		t = now();
+		for(n = 0; n < BENCH_BYTES; n += sizeof(buf))
+			health_test(&h, buf, sizeof(buf));
+		if((t = now() - t) < best)
+			best = t;
+	}
+	return BENCH_BYTES / best / 1e6;
+}
+
+static double bench_reseed(struct SRNG_st *st)
+{
+	double t, best = 1e9;
+	int run, i;
+
+	for(run = 0; run < BENCH_RUNS; run++) {
+		t = now();
+		for(i = 0; i < BENCH_RESEEDS; i++)
+			SRNG_reseed(st);
+		if((t = now() - t) < best)
+			best = t;
+	}
+	return best / BENCH_RESEEDS * 1e6;
+}
+
+static double bench_bytes(struct SRNG_st *st, unsigned int chunk)
+{
+	double t, best = 1e9;
+	unsigned long long n;
+	int run;
+
+	for(run = 0; run < BENCH_RUNS; run++) {
+		t = now();
+		for(n = 0; n < BENCH_BYTES; n += chunk)
+			SRNG_bytes(st, buf, chunk);
+		if((t = now() - t) < best)
+			best = t;
+	}
+	return BENCH_BYTES / best / 1e6;
+}
+
+int main(int argc, char **argv)
+{
+	struct SRNG_st *st;
+	unsigned int chunk = argc > 2 ? atoi(argv[2]) : 32;
+	enum exception_code exception;
+
+	init_exception_context(&exception_context);
+	if(argc < 2 || argc > 3 || !chunk || chunk > BENCH_BUF) {
+		fprintf(stderr, "USAGE: %s RNG [CHUNK]   (CHUNK 1 to %u)\n",
+				argv[0], BENCH_BUF);
+		return 1;
+	}
+	if(!SRNG_select(argv[1])) {
+		fprintf(stderr, "ERROR: unknown random number generator %s\n",
+				argv[1]);
+		return 1;
+	}
+
+	Try {
+		if(!(st = malloc(SRNG_init(NULL)))) {
+			perror("malloc");
+			return 1;
+		}
+		SRNG_init(st);
+
+		printf("%s, %u byte requests\n", SRNG_name(st), chunk);
+		printf("  health tests   %8.0f MB/s\n", bench_health(st));
+		printf("  reseed         %8.1f us\n", bench_reseed(st));
+		printf("  default policy %8.0f MB/s\n", bench_bytes(st, chunk));
+		SRNG_reseed_interval(st, 0, 0);
+		printf("  policy off     %8.0f MB/s\n", bench_bytes(st, chunk));
+		/* the time limit is never reached within a run */
+		SRNG_reseed_interval(st, 1 << 20, 0);
+		printf("  1 MiB interval %8.0f MB/s\n", bench_bytes(st, chunk));
+
+		SRNG_destroy(st);
+		free(st);
+	} Catch(exception) {
+		fprintf(stderr, "ERROR: exception %d\n", exception);
+		return 1;
+	}
+	return 0;
+}
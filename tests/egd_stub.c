@@ -0,0 +1,132 @@
+/*
+  egd_stub.c - a minimal EGD for the test suite
+  (c) 2026 the secpwgen contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining
+  a copy of this software and associated documentation files (the
+  "Software"), to deal in the Software without restriction, including
+  without limitation the rights to use, copy, modify, merge, publish,
+  distribute, sublicense, and/or sell copies of the Software, and to
+  permit persons to whom the Software is furnished to do so, subject to
+  the following conditions:
+
+  The above copyright notice and this permission notice shall be
+  included in all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+  EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+  MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+  IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+  CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+  TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+  SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+ * USAGE: egd_stub PATH answer|silent
+ *
+ * Listens on the UNIX socket PATH and serves one client at a time. With
+ * "answer" the two read commands of the EGD protocol are answered from
+ * /dev/urandom: 0x01 COUNT (non-blocking) with a count byte and that many
+ * bytes, 0x02 COUNT (blocking) with exactly COUNT bytes. Any other command
+ * is rejected by closing the connection. With "silent" connections are
+ * accepted and read but never answered, like a daemon that has run out of
+ * entropy. Runs until killed.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+static int read_all(int fd, unsigned char *buf, unsigned int n)
+{
+	ssize_t ret;
+
+	while(n) {
+		if((ret = read(fd, buf, n)) <= 0)
+			return -1;
+		buf += ret; n -= ret;
+	}
+	return 0;
+}
+
+static int write_all(int fd, const unsigned char *buf, unsigned int n)
+{
+	ssize_t ret;
+
+	while(n) {
+		if((ret = write(fd, buf, n)) <= 0)
+			return -1;
+		buf += ret; n -= ret;
+	}
+	return 0;
+}
+
+/* EGD commands */
+#define	EGD_READ_NONBLOCKING	0x01
+#define	EGD_READ_BLOCKING		0x02
+
+static void serve(int fd, int urandom, int silent)
+{
+	unsigned char request[2], buf[1 + 255];
+
+	while(!read_all(fd, request, sizeof(request))) {
+		if(silent)
+			continue;
+		switch(request[0]) {
+		case EGD_READ_NONBLOCKING:
+			buf[0] = request[1];
+			if(read_all(urandom, buf + 1, request[1]) < 0
+			|| write_all(fd, buf, 1 + request[1]) < 0)
+				return;
+			break;
+		case EGD_READ_BLOCKING:
+			if(read_all(urandom, buf, request[1]) < 0
+			|| write_all(fd, buf, request[1]) < 0)
+				return;
+			break;
+		default:
+			fprintf(stderr, "egd_stub: unsupported command 0x%02x\n",
+					request[0]);
+			return;
+		}
+	}
+}
+
+int main(int argc, char **argv)
+{
+	struct sockaddr_un addr;
+	int sock, fd, urandom, silent;
+
+	if(argc != 3 || strlen(argv[1]) >= sizeof(addr.sun_path)
+	|| (strcmp(argv[2], "answer") && strcmp(argv[2], "silent"))) {
+		fprintf(stderr, "USAGE: %s PATH answer|silent\n", argv[0]);
+		return 1;
+	}
+	silent = !strcmp(argv[2], "silent");
+
+	if((urandom = open("/dev/urandom", O_RDONLY)) < 0) {
+		perror("/dev/urandom");
+		return 1;
+	}
+	memset(&addr, 0, sizeof(addr));
+	addr.sun_family = AF_UNIX;
+	strcpy(addr.sun_path, argv[1]);
+	unlink(argv[1]);
+	if((sock = socket(AF_UNIX, SOCK_STREAM, 0)) < 0
+	|| bind(sock, (struct sockaddr*)&addr, sizeof(addr)) < 0
+	|| listen(sock, 4) < 0) {
+		perror(argv[1]);
+		return 1;
+	}
+
+	for(;;) {
+		if((fd = accept(sock, NULL, NULL)) < 0)
+			continue;
+		serve(fd, urandom, silent);
+		close(fd);
+	}
+}
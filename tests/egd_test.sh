@@ -0,0 +1,52 @@
+#!/bin/sh
+#
+# Seeding from EGD: once from a daemon that answers, once from one that
+# never answers, which must time out and fall back to the generator's own
+# seed. The kernel's pool is made to look uninitialized (nogetrandom.so)
+# and --hwrng names a missing device, so the chain actually reaches EGD.
+#
+# USAGE: egd_test.sh SECPWGEN   (run from the top directory by make check)
+
+SECPWGEN=${1:-tests/secpwgen}
+DIR=`mktemp -d /tmp/secpwgen-egd.XXXXXX` || exit 1
+PIDS=
+FAILED=0
+
+cleanup()
+{
+	[ -n "$PIDS" ] && kill $PIDS 2>/dev/null
+	rm -rf "$DIR"
+}
+trap cleanup EXIT
+
+start_stub()
+{
+	tests/egd_stub "$DIR/$1" $1 &
+	PIDS="$PIDS $!"
+	while [ ! -S "$DIR/$1" ]; do
+		sleep 0.1
+	done
+}
+
+# run_case NAME MODE EXPECTED-STDERR-PATTERN
+run_case()
+{
+	LD_PRELOAD=`pwd`/tests/nogetrandom.so "$SECPWGEN" \
+		--hwrng="$DIR/no-such-device" --egd="$DIR/$2" -r 128 \
+		>"$DIR/out" 2>"$DIR/err"
+	if [ $? -eq 0 ] && grep -q "$3" "$DIR/err"; then
+		echo "PASS: $1"
+	else
+		echo "FAIL: $1"
+		cat "$DIR/err"
+		FAILED=1
+	fi
+}
+
+start_stub answer
+start_stub silent
+
+run_case "EGD answers" answer "INFO: seeded from EGD\."
+run_case "EGD never answers" silent "WARNING: EGD socket .*: no answer within"
+
+exit $FAILED
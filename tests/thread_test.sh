@@ -0,0 +1,47 @@
+#!/bin/sh
+#
+# The threads (--prefill, --threads=N) must start without privileges:
+# mlockall() locks every thread stack, and an unprivileged user may lock
+# only RLIMIT_MEMLOCK bytes (usually 8 MiB). Run as root, the cases are
+# run as nobody through setpriv(1), which is skipped if it is missing.
+#
+# USAGE: thread_test.sh SECPWGEN   (run from the top directory by make check)
+
+SECPWGEN=${1:-tests/secpwgen}
+case $SECPWGEN in
+/*)	;;
+*)	SECPWGEN=`pwd`/$SECPWGEN ;;
+esac
+DIR=`mktemp -d /tmp/secpwgen-thread.XXXXXX` || exit 1
+RUN=
+FAILED=0
+
+trap 'rm -rf "$DIR"' EXIT
+
+if [ `id -u` -eq 0 ]; then
+	if ! command -v setpriv >/dev/null; then
+		echo "SKIP: thread tests (root, and no setpriv to drop privileges)"
+		exit 0
+	fi
+	RUN="setpriv --reuid=65534 --regid=65534 --clear-groups"
+	chmod 777 "$DIR"
+fi
+
+# run_case NAME ARGS...
+run_case()
+{
+	NAME=$1
+	shift
+	if (cd "$DIR" && $RUN "$SECPWGEN" "$@") >"$DIR/out" 2>"$DIR/err"; then
+		echo "PASS: $NAME"
+	else
+		echo "FAIL: $NAME"
+		cat "$DIR/err"
+		FAILED=1
+	fi
+}
+
+run_case "prefill thread" --prefill -p 5
+run_case "32 keyfile threads" --threads=32 --output=key -R 100000000
+
+exit $FAILED